@@ -0,0 +1,132 @@
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include "Allocations.h"
+
+static const char* s_SiteNames[] = { "other", "decode", "turn", "broadcast", "send", "spectators" };
+
+#ifdef GRIDGAME_ALLOC_TRACKING
+static std::atomic<uint64_t> s_Count = 0;
+static std::atomic<uint64_t> s_Bytes = 0;
+static std::atomic<uint64_t> s_SiteCount[(uint32_t)AllocationSite::SITE_COUNT];
+static std::atomic<uint64_t> s_SiteBytes[(uint32_t)AllocationSite::SITE_COUNT];
+static thread_local AllocationSite t_Site = AllocationSite::SITE_OTHER;
+
+void* operator new(std::size_t Size)
+{
+	s_Count.fetch_add(1, std::memory_order_relaxed);
+	s_Bytes.fetch_add(Size, std::memory_order_relaxed);
+	s_SiteCount[(uint32_t)t_Site].fetch_add(1, std::memory_order_relaxed);
+	s_SiteBytes[(uint32_t)t_Site].fetch_add(Size, std::memory_order_relaxed);
+
+	if (void* pData = std::malloc(Size ? Size : 1))
+		return pData;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t Size)
+{
+	return operator new(Size);
+}
+
+void operator delete(void* pData) noexcept
+{
+	std::free(pData);
+}
+
+void operator delete[](void* pData) noexcept
+{
+	std::free(pData);
+}
+
+void operator delete(void* pData, std::size_t) noexcept
+{
+	std::free(pData);
+}
+
+void operator delete[](void* pData, std::size_t) noexcept
+{
+	std::free(pData);
+}
+#endif
+
+bool Allocations::IsTracking()
+{
+#ifdef GRIDGAME_ALLOC_TRACKING
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint64_t Allocations::GetCount()
+{
+#ifdef GRIDGAME_ALLOC_TRACKING
+	return s_Count.load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
+uint64_t Allocations::GetBytes()
+{
+#ifdef GRIDGAME_ALLOC_TRACKING
+	return s_Bytes.load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
+uint64_t Allocations::GetCount(AllocationSite Site)
+{
+#ifdef GRIDGAME_ALLOC_TRACKING
+	return s_SiteCount[(uint32_t)Site].load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
+uint64_t Allocations::GetBytes(AllocationSite Site)
+{
+#ifdef GRIDGAME_ALLOC_TRACKING
+	return s_SiteBytes[(uint32_t)Site].load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
+AllocationSite Allocations::GetPacketSite(NetDataType Type)
+{
+	if ((uint32_t)Type >= ALLOCATIONS_NET_TYPES)
+		return AllocationSite::SITE_OTHER;
+
+	return (AllocationSite)((uint32_t)AllocationSite::SITE_PACKET + (uint32_t)Type);
+}
+
+const char* Allocations::GetSiteName(AllocationSite Site)
+{
+	if (Site >= AllocationSite::SITE_PACKET)
+		return "packet";
+
+	return s_SiteNames[(uint32_t)Site];
+}
+
+AllocationSite Allocations::Enter(AllocationSite Site)
+{
+#ifdef GRIDGAME_ALLOC_TRACKING
+	AllocationSite Previous = t_Site;
+	t_Site = Site;
+
+	return Previous;
+#else
+	return Site;
+#endif
+}
+
+void Allocations::Leave(AllocationSite Previous)
+{
+#ifdef GRIDGAME_ALLOC_TRACKING
+	t_Site = Previous;
+#endif
+}
\ No newline at end of file
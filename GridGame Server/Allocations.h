@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include "Packet.h"
+
+#define ALLOCATIONS_NET_TYPES 32
+
+// Where an allocation happened, packets are further split by their type
+enum class AllocationSite : uint32_t
+{
+	SITE_OTHER,
+	SITE_DECODE,
+	SITE_TURN,
+	SITE_BROADCAST,
+	SITE_SEND,
+	SITE_SPECTATORS,
+	SITE_PACKET,
+	SITE_COUNT = SITE_PACKET + ALLOCATIONS_NET_TYPES
+};
+
+// Global allocation counters, only counting when built with GRIDGAME_ALLOC_TRACKING
+class Allocations
+{
+public:
+	static bool IsTracking();
+	static uint64_t GetCount();
+	static uint64_t GetBytes();
+	static uint64_t GetCount(AllocationSite Site);
+	static uint64_t GetBytes(AllocationSite Site);
+	static AllocationSite GetPacketSite(NetDataType Type);
+	static const char* GetSiteName(AllocationSite Site);
+
+private:
+	friend class AllocationScope;
+
+	static AllocationSite Enter(AllocationSite Site);
+	static void Leave(AllocationSite Previous);
+};
+
+// Attributes the allocations of the current thread to a site until the scope ends, nested scopes win
+class AllocationScope
+{
+public:
+#ifdef GRIDGAME_ALLOC_TRACKING
+	AllocationScope(AllocationSite Site)
+	{
+		m_Previous = Allocations::Enter(Site);
+	}
+
+	~AllocationScope()
+	{
+		Allocations::Leave(m_Previous);
+	}
+
+private:
+	AllocationSite m_Previous;
+#else
+	AllocationScope(AllocationSite Site)
+	{
+	}
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include <format>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include "Benchmark.h"
+#include "Field.h"
+#include "Rules.h"
+#include "Client.h"
+#include "Serializer.h"
+#include "Allocations.h"
+#include "GridGame.h"
+#include "Bot.h"
+#include "SimState.h"
+#include "MctsSearch.h"
+#include "DynamicBuffer.h"
+#include "GameNetInstructions.h"
+
+#undef max
+#undef min
+
+static volatile std::size_t s_Sink = 0;
+
+int Benchmark::RunSerializer()
+{
+	std::map<NetDataType, Instruction> Instructions;
+	GetGameInstructions(&Instructions);
+
+	Serializer Serializer;
+	Serializer.SetInstructions(&Instructions);
+
+	std::vector<char> Buffer;
+
+	std::cout << std::format("{:<40} {:>12} {:>12} {:>12}", "Benchmark", "ns/op", "MB/s", "allocs/op") << std::endl;
+
+	// Serialize every message at a realistic size
+	const std::pair<const char*, NetDataType> Messages[] = {
+		{ "Connect", NetDataType::NET_CONNECT },
+		{ "ConnectAck", NetDataType::NET_CONNECT_ACK },
+		{ "GameStart", NetDataType::NET_GAME_START },
+		{ "Move", NetDataType::NET_MOVE },
+		{ "Broadcast", NetDataType::NET_BROADCAST },
+		{ "GameData", NetDataType::NET_GAME_DATA },
+		{ "MoveBatch", NetDataType::NET_MOVE_BATCH },
+		{ "MoveBatchResult", NetDataType::NET_MOVE_BATCH_RESULT },
+	};
+
+	for (auto [Name, Type] : Messages)
+	{
+		Packet Message = MakePacket(Type);
+		std::size_t Bytes = Serializer.Serialize(Message, &Buffer);
+
+		Measure(std::format("Serialize/{}", Name), Bytes, [&]()
+		{
+			s_Sink = s_Sink + Serializer.Serialize(Message, &Buffer);
+		});
+	}
+
+	// Deserialize a whole game data packet
+	Packet Message = MakePacket(NetDataType::NET_GAME_DATA);
+	std::size_t Bytes = Serializer.Serialize(Message, &Buffer);
+	std::vector<char> Wire(Buffer.begin(), Buffer.begin() + Bytes);
+	DynamicBuffer Stream(BUFFER_SIZE);
+
+	Measure("Deserialize/GameData/Whole", Bytes, [&]()
+	{
+		Packet Result;
+		Stream.Append(Wire.data(), Wire.size());
+		Serializer.Deserialize(&Stream, &Result);
+		s_Sink = s_Sink + Result.m_Data.size();
+	});
+
+	// Same packet arriving in small TCP segments, parsed after every segment
+	Measure("Deserialize/GameData/Fragmented", Bytes, [&]()
+	{
+		Packet Result;
+
+		for (std::size_t Offset = 0; Offset < Wire.size(); Offset += 64)
+		{
+			Stream.Append(Wire.data() + Offset, std::min<std::size_t>(64, Wire.size() - Offset));
+			Result.m_Data.clear();
+
+			if (Serializer.Deserialize(&Stream, &Result) == Serializer::State::STATE_SUCCESS)
+				break;
+		}
+
+		s_Sink = s_Sink + Result.m_Data.size();
+	});
+
+	// Many small moves arriving in one read
+	Message = MakePacket(NetDataType::NET_MOVE);
+	Bytes = Serializer.Serialize(Message, &Buffer);
+	std::vector<char> Pipelined;
+
+	for (int i = 0; i < 64; i++)
+		Pipelined.insert(Pipelined.end(), Buffer.begin(), Buffer.begin() + Bytes);
+
+	Measure("Deserialize/Move/Pipelined x64", Pipelined.size(), [&]()
+	{
+		Stream.Append(Pipelined.data(), Pipelined.size());
+
+		while (Stream.GetSize() > 0)
+		{
+			Packet Result;
+
+			if (Serializer.Deserialize(&Stream, &Result) != Serializer::State::STATE_SUCCESS)
+				break;
+
+			s_Sink = s_Sink + Result.m_Data.size();
+		}
+	});
+
+	// Streaming receive buffer: socket sized appends, packet sized pops
+	std::vector<char> Chunk(BUFFER_SIZE, 1);
+
+	Measure("DynamicBuffer/Append+Pop", Chunk.size(), [&]()
+	{
+		Stream.Append(Chunk.data(), Chunk.size());
+
+		while (Stream.GetSize() >= 96)
+			Stream.Pop(96);
+	});
+
+	Stream.Clear();
+
+	// Building a large struct array like a full grid update
+	std::vector<PacketStruct> Structs(4096, PacketStruct{ (uint16_t)1, (uint16_t)2, (uint8_t)2, (uint8_t)0, (int16_t)5 });
+
+	Measure("Packet/push_back 4096 structs", Structs.size() * 5 * sizeof(PacketData), [&]()
+	{
+		Packet Result(NetDataType::NET_GAME_DATA);
+		Result.push_back(Structs);
+		s_Sink = s_Sink + Result.m_Data.size();
+	});
+
+	if (!Allocations::IsTracking())
+		std::cout << "Allocations are only counted when built with GRIDGAME_ALLOC_TRACKING." << std::endl;
+
+	return 0;
+}
+
+int Benchmark::RunMcts()
+{
+	std::cout << std::format("{:<40} {:>12} {:>12} {:>12}", "Benchmark", "ns/op", "MB/s", "allocs/op") << std::endl;
+
+	for (uint16_t Size : { (uint16_t)25, (uint16_t)64 })
+	{
+		GameConfig Config;
+		Config.m_GridWidth = Size;
+		Config.m_GridHeight = Size;
+		Config.m_Seed = 1;
+
+		GridGame Game(nullptr, Config);
+		std::vector<Bot> Bots;
+
+		// Play into the midgame so the search sees several workers and food
+		std::cout.setstate(std::ios::badbit);
+
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			Bots.push_back(Bot(BotType::BOT_GREEDY_FOOD, (SOCKET)(i + 1), i + 1));
+			Bots.back().Connect(&Game);
+		}
+
+		Game.BeginMatch();
+
+		for (uint32_t Turn = 0; Turn < BENCHMARK_MCTS_TURNS && Game.IsGameRunning(); Turn++)
+		{
+			for (Bot& Bot : Bots)
+			{
+				if (Bot.IsTurnPlayer(&Game))
+					Bot.Play(&Game);
+			}
+
+			Game.AdvanceTurn(false);
+		}
+
+		std::cout.clear();
+
+		if (!Game.IsGameRunning())
+			continue;
+
+		// Cost of one clone and one playout of a whole board window
+		SimState State;
+		SimState Copy;
+		Random Random(1);
+
+		State.Load(Game.GetGrid(), 0, 0, std::min<uint16_t>(Size, SIM_MAX_SIZE), std::min<uint16_t>(Size, SIM_MAX_SIZE));
+		std::size_t Bytes = (std::size_t)State.GetWidth() * State.GetHeight() * sizeof(SimCell);
+
+		Measure(std::format("SimState/Clone/{}x{}", State.GetWidth(), State.GetHeight()), Bytes, [&]()
+		{
+			Copy = State;
+			s_Sink = s_Sink + Copy.GetWidth();
+		});
+
+		Measure(std::format("SimState/Playout/{}x{}", State.GetWidth(), State.GetHeight()), Bytes, [&]()
+		{
+			Copy = State;
+
+			for (uint32_t Turn = 0; Turn < MCTS_ROLLOUT_TURNS; Turn++)
+				Copy.PlayRandomTurn(&Random);
+		});
+
+		// Rollouts per second of a whole search as threads are added
+		std::vector<MctsMove> Moves;
+
+		for (std::size_t Threads = 1; Threads <= std::max(1u, std::thread::hardware_concurrency()); Threads *= 2)
+		{
+			MctsSearch Search(Threads);
+			Search.Prepare(Game.GetGrid(), Game.GetTurnPlayerID());
+			Search.Search(BENCHMARK_MCTS_SECONDS, 1, &Moves);
+
+			std::cout << std::format("{:<40} {:>12.0f} rollouts/s, {:.0f} per thread, {} moves planned",
+				std::format("Mcts/{}x{}/{}threads", Size, Size, Threads),
+				Search.GetRollouts() / BENCHMARK_MCTS_SECONDS,
+				Search.GetRollouts() / BENCHMARK_MCTS_SECONDS / Threads,
+				Moves.size()) << std::endl;
+		}
+	}
+
+	return 0;
+}
+
+void Benchmark::Measure(const std::string& Name, std::size_t BytesPerOp, const std::function<void()>& Operation)
+{
+	// Warm up caches and buffer capacities
+	for (int i = 0; i < 100; i++)
+		Operation();
+
+	uint64_t Iterations = 0;
+	uint64_t AllocsBefore = Allocations::GetCount();
+	auto Start = std::chrono::steady_clock::now();
+	double Seconds = 0;
+
+	// Run in growing batches to keep clock reads out of the measurement
+	for (uint64_t Batch = 64; Seconds < BENCHMARK_MIN_SECONDS; Batch *= 2)
+	{
+		for (uint64_t i = 0; i < Batch; i++)
+			Operation();
+
+		Iterations += Batch;
+		Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	}
+
+	uint64_t Allocs = Allocations::GetCount() - AllocsBefore;
+
+	std::cout << std::format("{:<40} {:>12.1f} {:>12.1f} {:>12}",
+		Name,
+		Seconds * 1e9 / Iterations,
+		BytesPerOp * Iterations / Seconds / 1e6,
+		Allocations::IsTracking() ? std::format("{:.2f}", (double)Allocs / Iterations) : "n/a") << std::endl;
+}
+
+Packet Benchmark::MakePacket(NetDataType Type)
+{
+	Packet Message(Type);
+
+	switch (Type)
+	{
+	case NetDataType::NET_CONNECT:
+		Message.push_back(std::string("PlayerName123"));
+		break;
+	case NetDataType::NET_CONNECT_ACK:
+		Message.push_back((uint8_t)3);
+		Message.push_back((uint64_t)0x5EED5EED5EED5EED);
+		break;
+	case NetDataType::NET_GAME_START:
+	{
+		std::vector<PacketStruct> Players;
+
+		for (uint8_t i = 0; i < 8; i++)
+			Players.push_back({ i, std::format("Player{}", i) });
+
+		Message.push_back((uint16_t)64);
+		Message.push_back((uint16_t)64);
+		Message.push_back(Players);
+		break;
+	}
+	case NetDataType::NET_MOVE:
+		Message.push_back(false);
+		Message.push_back((uint16_t)10);
+		Message.push_back((uint16_t)10);
+		Message.push_back((uint16_t)11);
+		Message.push_back((uint16_t)10);
+		break;
+	case NetDataType::NET_BROADCAST:
+		Message.push_back(std::string("Player [PlayerName123] has won the game."));
+		break;
+	case NetDataType::NET_GAME_DATA:
+	{
+		// A busy turn on a mid sized board
+		std::vector<PacketStruct> Fields;
+		std::vector<PacketStruct> Food;
+
+		for (uint16_t i = 0; i < 256; i++)
+			Fields.push_back({ (uint16_t)(i % 64), (uint16_t)(i / 64), (uint8_t)Field::FieldType::FIELD_WORKER, (uint8_t)(i % 8), (int16_t)(i % 20) });
+
+		for (uint16_t i = 0; i < 16; i++)
+			Food.push_back({ (uint16_t)(i * 3), (uint16_t)(i * 2) });
+
+		Message.push_back((uint8_t)1);
+		Message.push_back((int64_t)1700000000);
+		Message.push_back(Fields);
+		Message.push_back(Food);
+		Message.push_back((uint32_t)42);
+		break;
+	}
+	case NetDataType::NET_MOVE_BATCH:
+	{
+		std::vector<PacketStruct> Moves;
+
+		for (uint16_t i = 0; i < 256; i++)
+			Moves.push_back({ false, (uint16_t)(i % 64), (uint16_t)(i / 64), (uint16_t)(i % 64 + 1), (uint16_t)(i / 64) });
+
+		Message.push_back(Moves);
+		break;
+	}
+	case NetDataType::NET_MOVE_BATCH_RESULT:
+	{
+		std::vector<PacketStruct> Rejected;
+
+		for (uint16_t i = 0; i < 32; i++)
+			Rejected.push_back({ (uint16_t)(i * 8), (uint8_t)MoveResult::MOVE_TOO_FAR });
+
+		Message.push_back((uint16_t)224);
+		Message.push_back(Rejected);
+		break;
+	}
+	default:
+		break;
+	}
+
+	return Message;
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+#include <map>
+#include <string>
+#include <functional>
+#include "Packet.h"
+#include "Instruction.h"
+
+#define BENCHMARK_MIN_SECONDS 0.25
+#define BENCHMARK_MCTS_SECONDS 1.0
+#define BENCHMARK_MCTS_TURNS 40
+
+// Microbenchmarks of the hot paths: serialization, deserialization, buffers and the AI search
+class Benchmark
+{
+public:
+	static int RunSerializer();
+	static int RunMcts();
+
+private:
+	static void Measure(const std::string& Name, std::size_t BytesPerOp, const std::function<void()>& Operation);
+	static Packet MakePacket(NetDataType Type);
+};
\ No newline at end of file
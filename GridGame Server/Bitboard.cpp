@@ -0,0 +1,313 @@
+#include <algorithm>
+#include "Bitboard.h"
+
+#undef max
+#undef min
+
+Bitboard::Bitboard() : Bitboard(0, 0)
+{
+}
+
+Bitboard::Bitboard(uint16_t Width, uint16_t Height)
+{
+	Resize(Width, Height);
+}
+
+void Bitboard::Resize(uint16_t Width, uint16_t Height)
+{
+	m_Width = Width;
+	m_Height = Height;
+	m_TilesX = (Width + BITBOARD_TILE_SIZE - 1) / BITBOARD_TILE_SIZE;
+	m_TilesY = (Height + BITBOARD_TILE_SIZE - 1) / BITBOARD_TILE_SIZE;
+
+	Clear();
+}
+
+void Bitboard::Clear()
+{
+	// The tile index itself is only allocated with the first tile, keeps capacity for reuse
+	m_TileIndex.clear();
+	m_Tiles.clear();
+}
+
+void Bitboard::Fill()
+{
+	for (uint32_t TileIndex = 0; TileIndex < (uint32_t)m_TilesX * m_TilesY; TileIndex++)
+	{
+		uint32_t TileX = TileIndex % m_TilesX;
+		uint32_t TileY = TileIndex / m_TilesX;
+		Tile* pTile = GetWritableTile(TileIndex);
+
+		for (uint32_t Row = 0; Row < BITBOARD_TILE_SIZE; Row++)
+			(*pTile)[Row] = TileY * BITBOARD_TILE_SIZE + Row < m_Height ? GetColumnMask(TileX) : 0;
+	}
+}
+
+void Bitboard::Set(uint16_t x, uint16_t y)
+{
+	Tile* pTile = GetWritableTile((y / BITBOARD_TILE_SIZE) * m_TilesX + x / BITBOARD_TILE_SIZE);
+	(*pTile)[y % BITBOARD_TILE_SIZE] |= 1ull << (x % BITBOARD_TILE_SIZE);
+}
+
+void Bitboard::Reset(uint16_t x, uint16_t y)
+{
+	if (m_TileIndex.empty())
+		return;
+
+	uint32_t Index = m_TileIndex[(y / BITBOARD_TILE_SIZE) * m_TilesX + x / BITBOARD_TILE_SIZE];
+
+	if (Index != BITBOARD_NO_TILE)
+		m_Tiles[Index][y % BITBOARD_TILE_SIZE] &= ~(1ull << (x % BITBOARD_TILE_SIZE));
+}
+
+void Bitboard::Assign(uint16_t x, uint16_t y, bool Value)
+{
+	if (Value)
+		Set(x, y);
+	else
+		Reset(x, y);
+}
+
+void Bitboard::And(const Bitboard& Other)
+{
+	for (uint32_t TileIndex = 0; TileIndex < m_TileIndex.size(); TileIndex++)
+	{
+		if (m_TileIndex[TileIndex] == BITBOARD_NO_TILE)
+			continue;
+
+		Tile& Words = m_Tiles[m_TileIndex[TileIndex]];
+		const Tile* pOther = Other.GetTile(TileIndex % m_TilesX, TileIndex / m_TilesX);
+
+		for (uint32_t Row = 0; Row < BITBOARD_TILE_SIZE; Row++)
+			Words[Row] &= pOther ? (*pOther)[Row] : 0;
+	}
+}
+
+void Bitboard::AndNot(const Bitboard& Other)
+{
+	for (uint32_t TileIndex = 0; TileIndex < m_TileIndex.size(); TileIndex++)
+	{
+		if (m_TileIndex[TileIndex] == BITBOARD_NO_TILE)
+			continue;
+
+		const Tile* pOther = Other.GetTile(TileIndex % m_TilesX, TileIndex / m_TilesX);
+
+		if (!pOther)
+			continue;
+
+		Tile& Words = m_Tiles[m_TileIndex[TileIndex]];
+
+		for (uint32_t Row = 0; Row < BITBOARD_TILE_SIZE; Row++)
+			Words[Row] &= ~(*pOther)[Row];
+	}
+}
+
+void Bitboard::Or(const Bitboard& Other)
+{
+	for (uint32_t TileIndex = 0; TileIndex < Other.m_TileIndex.size(); TileIndex++)
+	{
+		if (Other.m_TileIndex[TileIndex] == BITBOARD_NO_TILE)
+			continue;
+
+		const Tile& OtherWords = Other.m_Tiles[Other.m_TileIndex[TileIndex]];
+		Tile* pTile = GetWritableTile(TileIndex);
+
+		for (uint32_t Row = 0; Row < BITBOARD_TILE_SIZE; Row++)
+			(*pTile)[Row] |= OtherWords[Row];
+	}
+}
+
+void Bitboard::Dilate(uint16_t Radius, Bitboard* pOut) const
+{
+	pOut->Resize(m_Width, m_Height);
+
+	if (m_TileIndex.empty())
+		return;
+
+	// Every field within Radius steps in any of the 8 directions, only direct neighbour tiles reach in
+	Radius = std::min<uint16_t>(Radius, BITBOARD_TILE_SIZE - 1);
+
+	// Spread every row horizontally first
+	for (int TileY = 0; TileY < m_TilesY; TileY++)
+	{
+		for (int TileX = 0; TileX < m_TilesX; TileX++)
+		{
+			if (!GetTile(TileX - 1, TileY) && !GetTile(TileX, TileY) && !GetTile(TileX + 1, TileY))
+				continue;
+
+			Tile* pResult = nullptr;
+
+			for (uint32_t Row = 0; Row < BITBOARD_TILE_SIZE; Row++)
+			{
+				uint64_t Bits = DilateRow(TileX, TileY, Row, Radius) & GetColumnMask(TileX);
+
+				if (!Bits)
+					continue;
+
+				if (!pResult)
+					pResult = pOut->GetWritableTile(TileY * m_TilesX + TileX);
+
+				(*pResult)[Row] = Bits;
+			}
+		}
+	}
+
+	// Then every column of tiles vertically over the whole board height
+	std::array<uint64_t, BITBOARD_MAX_SIZE> Column;
+
+	for (int TileX = 0; TileX < m_TilesX; TileX++)
+	{
+		bool IsEmpty = true;
+
+		for (int TileY = 0; TileY < m_TilesY; TileY++)
+		{
+			const Tile* pTile = pOut->GetTile(TileX, TileY);
+
+			for (uint32_t Row = 0; Row < BITBOARD_TILE_SIZE && TileY * BITBOARD_TILE_SIZE + Row < m_Height; Row++)
+				Column[TileY * BITBOARD_TILE_SIZE + Row] = pTile ? (*pTile)[Row] : 0;
+
+			IsEmpty &= !pTile;
+		}
+
+		if (IsEmpty)
+			continue;
+
+		// Spread in doubling steps, one pass up and one pass down each, which add up to Radius
+		for (uint32_t Remaining = Radius, Step = 1; Remaining; Remaining -= Step, Step *= 2)
+		{
+			Step = std::min(Step, Remaining);
+
+			for (uint32_t y = 0; y + Step < m_Height; y++)
+				Column[y] |= Column[y + Step];
+
+			for (uint32_t y = m_Height - 1; y >= Step; y--)
+				Column[y] |= Column[y - Step];
+		}
+
+		for (int TileY = 0; TileY < m_TilesY; TileY++)
+		{
+			Tile* pResult = nullptr;
+
+			for (uint32_t Row = 0; Row < BITBOARD_TILE_SIZE && TileY * BITBOARD_TILE_SIZE + Row < m_Height; Row++)
+			{
+				uint64_t Bits = Column[TileY * BITBOARD_TILE_SIZE + Row];
+
+				if (!Bits && !pResult)
+					continue;
+
+				if (!pResult)
+					pResult = pOut->GetWritableTile(TileY * m_TilesX + TileX);
+
+				(*pResult)[Row] = Bits;
+			}
+		}
+	}
+}
+
+bool Bitboard::Test(uint16_t x, uint16_t y) const
+{
+	if (x >= m_Width || y >= m_Height)
+		return false;
+
+	const Tile* pTile = GetTile(x / BITBOARD_TILE_SIZE, y / BITBOARD_TILE_SIZE);
+
+	return pTile && ((*pTile)[y % BITBOARD_TILE_SIZE] >> (x % BITBOARD_TILE_SIZE)) & 1;
+}
+
+bool Bitboard::IsEmpty() const
+{
+	return std::all_of(m_Tiles.begin(), m_Tiles.end(), [](const Tile& Words)
+	{
+		return std::all_of(Words.begin(), Words.end(), [](uint64_t Word) { return Word == 0; });
+	});
+}
+
+uint64_t Bitboard::Count() const
+{
+	uint64_t Count = 0;
+
+	for (const Tile& Words : m_Tiles)
+	{
+		for (uint64_t Word : Words)
+			Count += std::popcount(Word);
+	}
+
+	return Count;
+}
+
+uint16_t Bitboard::GetWidth() const
+{
+	return m_Width;
+}
+
+uint16_t Bitboard::GetHeight() const
+{
+	return m_Height;
+}
+
+const Bitboard::Tile* Bitboard::GetTile(int TileX, int TileY) const
+{
+	if (m_TileIndex.empty() || TileX < 0 || TileX >= m_TilesX || TileY < 0 || TileY >= m_TilesY)
+		return nullptr;
+
+	uint32_t Index = m_TileIndex[TileY * m_TilesX + TileX];
+
+	return Index != BITBOARD_NO_TILE ? &m_Tiles[Index] : nullptr;
+}
+
+Bitboard::Tile* Bitboard::GetWritableTile(uint32_t TileIndex)
+{
+	if (m_TileIndex.empty())
+		m_TileIndex.assign((std::size_t)m_TilesX * m_TilesY, BITBOARD_NO_TILE);
+
+	if (m_TileIndex[TileIndex] == BITBOARD_NO_TILE)
+	{
+		m_TileIndex[TileIndex] = (uint32_t)m_Tiles.size();
+		m_Tiles.emplace_back().fill(0);
+	}
+
+	return &m_Tiles[m_TileIndex[TileIndex]];
+}
+
+uint64_t Bitboard::GetColumnMask(uint32_t TileX) const
+{
+	uint32_t Columns = m_Width - TileX * BITBOARD_TILE_SIZE;
+
+	return Columns >= BITBOARD_TILE_SIZE ? ~0ull : (1ull << Columns) - 1;
+}
+
+uint64_t Bitboard::DilateRow(int TileX, int TileY, uint32_t Row, uint16_t Radius) const
+{
+	const Tile* pTile = GetTile(TileX, TileY);
+	const Tile* pLeft = GetTile(TileX - 1, TileY);
+	const Tile* pRight = GetTile(TileX + 1, TileY);
+
+	// Row of the left tile, this tile and the right tile, bit i is column i
+	uint64_t Words[3] = { pLeft ? (*pLeft)[Row] : 0, pTile ? (*pTile)[Row] : 0, pRight ? (*pRight)[Row] : 0 };
+
+	if (!(Words[0] | Words[1] | Words[2]))
+		return 0;
+
+	// Spread in doubling steps which add up to Radius, bits further out than a tile never reach the middle
+	for (uint32_t Remaining = Radius, Step = 1; Remaining; Remaining -= Step, Step *= 2)
+	{
+		Step = std::min(Step, Remaining);
+
+		uint64_t Spread[3];
+
+		for (int i = 0; i < 3; i++)
+		{
+			Spread[i] = Words[i] | (Words[i] << Step) | (Words[i] >> Step);
+
+			if (i > 0)
+				Spread[i] |= Words[i - 1] >> (BITBOARD_TILE_SIZE - Step);
+
+			if (i < 2)
+				Spread[i] |= Words[i + 1] << (BITBOARD_TILE_SIZE - Step);
+		}
+
+		std::copy(Spread, Spread + 3, Words);
+	}
+
+	return Words[1];
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+#include <bit>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#define BITBOARD_TILE_SIZE 64
+#define BITBOARD_NO_TILE UINT32_MAX
+#define BITBOARD_MAX_SIZE 4096
+
+// One bit per field in tiles of 64x64 fields, one 64-bit word per tile row.
+// Tiles are only allocated once a bit in them gets set, so sparse boards stay small
+class Bitboard
+{
+public:
+	using Tile = std::array<uint64_t, BITBOARD_TILE_SIZE>;
+
+	Bitboard();
+	Bitboard(uint16_t Width, uint16_t Height);
+	void Resize(uint16_t Width, uint16_t Height);
+	void Clear();
+	void Fill();
+	void Set(uint16_t x, uint16_t y);
+	void Reset(uint16_t x, uint16_t y);
+	void Assign(uint16_t x, uint16_t y, bool Value);
+	void And(const Bitboard& Other);
+	void AndNot(const Bitboard& Other);
+	void Or(const Bitboard& Other);
+	void Dilate(uint16_t Radius, Bitboard* pOut) const;
+
+	bool Test(uint16_t x, uint16_t y) const;
+	bool IsEmpty() const;
+	uint64_t Count() const;
+	uint16_t GetWidth() const;
+	uint16_t GetHeight() const;
+
+	// Calls Callback(x, y) for every set bit, row by row within each tile
+	template <typename Function>
+	void ForEach(Function Callback) const
+	{
+		for (uint32_t TileIndex = 0; TileIndex < m_TileIndex.size(); TileIndex++)
+		{
+			if (m_TileIndex[TileIndex] == BITBOARD_NO_TILE)
+				continue;
+
+			const Tile& Words = m_Tiles[m_TileIndex[TileIndex]];
+			uint16_t TileX = (TileIndex % m_TilesX) * BITBOARD_TILE_SIZE;
+			uint16_t TileY = (TileIndex / m_TilesX) * BITBOARD_TILE_SIZE;
+
+			for (uint32_t Row = 0; Row < BITBOARD_TILE_SIZE; Row++)
+			{
+				uint64_t Bits = Words[Row];
+
+				while (Bits)
+				{
+					Callback((uint16_t)(TileX + std::countr_zero(Bits)), (uint16_t)(TileY + Row));
+					Bits &= Bits - 1;
+				}
+			}
+		}
+	}
+
+private:
+	const Tile* GetTile(int TileX, int TileY) const;
+	Tile* GetWritableTile(uint32_t TileIndex);
+	uint64_t GetColumnMask(uint32_t TileX) const;
+	uint64_t DilateRow(int TileX, int TileY, uint32_t Row, uint16_t Radius) const;
+
+	uint16_t m_Width;
+	uint16_t m_Height;
+	uint16_t m_TilesX;
+	uint16_t m_TilesY;
+	std::vector<uint32_t> m_TileIndex;
+	std::vector<Tile> m_Tiles;
+};
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include <format>
+#include "Bot.h"
+#include "GridGame.h"
+
+Bot::Bot(BotType Type, SOCKET Socket, uint64_t Seed)
+	: m_Client(Socket, std::format("10.{}.{}.{}", (Socket >> 16) & 0xFF, (Socket >> 8) & 0xFF, Socket & 0xFF), nullptr),
+	m_Random(Seed)
+{
+	m_Type = Type;
+}
+
+void Bot::Connect(GridGame* pGame)
+{
+	Packet Data(NetDataType::NET_CONNECT);
+	Data.push_back(std::format("Bot{}", (uint64_t)m_Client.m_Socket));
+
+	pGame->Receive(Data, m_Client);
+}
+
+bool Bot::IsTurnPlayer(GridGame* pGame) const
+{
+	Player* pPlayer = pGame->GetPlayerByClient(m_Client);
+
+	return pPlayer && pPlayer->m_ID == pGame->GetTurnPlayerID();
+}
+
+uint32_t Bot::Play(GridGame* pGame)
+{
+	Player* pPlayer = pGame->GetPlayerByClient(m_Client);
+
+	if (!pPlayer)
+		return 0;
+
+	const Grid& Grid = pGame->GetGrid();
+	uint8_t PlayerID = pPlayer->m_ID;
+	uint32_t Moves = 0;
+
+	// Collect workers first, moving them changes the bit planes we walk
+	m_Workers.clear();
+
+	Rules::GetMovable(Grid, PlayerID, &m_Movable);
+	m_Movable.ForEach([this](uint16_t x, uint16_t y) { m_Workers.push_back({ x, y }); });
+
+	for (auto [x, y] : m_Workers)
+	{
+		const Field& Worker = Grid.Get(x, y);
+		int StepX = 0;
+		int StepY = 0;
+
+		switch (m_Type)
+		{
+		case BotType::BOT_AGGRESSIVE:
+			if (FindTarget(pGame, x, y, true, &StepX, &StepY))
+				break;
+			[[fallthrough]];
+		case BotType::BOT_GREEDY_FOOD:
+			if (FindTarget(pGame, x, y, false, &StepX, &StepY))
+				break;
+			[[fallthrough]];
+		case BotType::BOT_RANDOM:
+			StepX = (int)m_Random.NextBounded(3) - 1;
+			StepY = (int)m_Random.NextBounded(3) - 1;
+			break;
+		}
+
+		if ((StepX == 0 && StepY == 0) || !Grid.IsInside(x + StepX, y + StepY))
+			continue;
+
+		// Strong workers split to cover more ground
+		bool Split = Worker.m_Power >= 4 && (m_Type != BotType::BOT_RANDOM || m_Random.NextBounded(2));
+
+		Packet Data(NetDataType::NET_MOVE);
+		Data.push_back(Split);
+		Data.push_back(x);
+		Data.push_back(y);
+		Data.push_back((uint16_t)(x + StepX));
+		Data.push_back((uint16_t)(y + StepY));
+
+		pGame->Receive(Data, m_Client);
+		Moves++;
+	}
+
+	pGame->Receive(Packet(NetDataType::NET_END_TURN), m_Client);
+
+	return Moves;
+}
+
+bool Bot::FindTarget(GridGame* pGame, uint16_t x, uint16_t y, bool Hunt, int* pStepX, int* pStepY) const
+{
+	const Grid& Grid = pGame->GetGrid();
+	const Field& Worker = Grid.Get(x, y);
+	int BestDistance = BOT_SEARCH_RADIUS + 1;
+
+	// Closest food, or closest weaker enemy worker when hunting
+	for (int OffsetY = -BOT_SEARCH_RADIUS; OffsetY <= BOT_SEARCH_RADIUS; OffsetY++)
+	{
+		for (int OffsetX = -BOT_SEARCH_RADIUS; OffsetX <= BOT_SEARCH_RADIUS; OffsetX++)
+		{
+			int Distance = std::max(std::abs(OffsetX), std::abs(OffsetY));
+
+			if (Distance == 0 || Distance >= BestDistance || !Grid.IsInside(x + OffsetX, y + OffsetY))
+				continue;
+
+			const Field& Target = Grid.Get(x + OffsetX, y + OffsetY);
+
+			if (Hunt)
+			{
+				if (Target.m_FieldType != Field::FieldType::FIELD_WORKER || Target.m_OwnerID == Worker.m_OwnerID || Target.m_Power >= Worker.m_Power)
+					continue;
+			}
+			else if (Target.m_FieldType != Field::FieldType::FIELD_FOOD)
+			{
+				continue;
+			}
+
+			BestDistance = Distance;
+			*pStepX = (OffsetX > 0) - (OffsetX < 0);
+			*pStepY = (OffsetY > 0) - (OffsetY < 0);
+		}
+	}
+
+	return BestDistance <= BOT_SEARCH_RADIUS;
+}
+
+bool Bot::ParseType(const std::string& Name, BotType* pType)
+{
+	if (Name == "random")
+		*pType = BotType::BOT_RANDOM;
+	else if (Name == "greedy")
+		*pType = BotType::BOT_GREEDY_FOOD;
+	else if (Name == "aggressive")
+		*pType = BotType::BOT_AGGRESSIVE;
+	else
+		return false;
+
+	return true;
+}
\ No newline at end of file
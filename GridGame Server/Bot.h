@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <winsock2.h>
+#include "Client.h"
+#include "Random.h"
+#include "Bitboard.h"
+
+#define BOT_SEARCH_RADIUS 5
+
+class GridGame;
+
+enum class BotType : uint8_t
+{
+	BOT_RANDOM,
+	BOT_GREEDY_FOOD,
+	BOT_AGGRESSIVE,
+};
+
+// Scripted player feeding moves through GridGame::Receive like a real client
+class Bot
+{
+public:
+	Bot(BotType Type, SOCKET Socket, uint64_t Seed);
+	void Connect(GridGame* pGame);
+	uint32_t Play(GridGame* pGame);
+	bool IsTurnPlayer(GridGame* pGame) const;
+
+	static bool ParseType(const std::string& Name, BotType* pType);
+
+private:
+	bool FindTarget(GridGame* pGame, uint16_t x, uint16_t y, bool Hunt, int* pStepX, int* pStepY) const;
+
+	BotType m_Type;
+	Client m_Client;
+	Random m_Random;
+	Bitboard m_Movable;
+	std::vector<std::pair<uint16_t, uint16_t>> m_Workers;
+};
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+
+#define CHECKPOINT_MAGIC 0x50434747
+#define CHECKPOINT_VERSION 4
+#define CHECKPOINT_IP_LENGTH 46
+#define CHECKPOINT_NAME_LENGTH 64
+
+// Fixed binary layout of a match checkpoint:
+// CheckpointHeader, PlayerCount * CheckpointPlayer, FieldCount * CheckpointField, FoodCount * CheckpointField
+#pragma pack(push, 1)
+struct CheckpointHeader
+{
+	uint32_t Magic;
+	uint16_t Version;
+	uint32_t CheckpointID;
+	uint16_t GridWidth;
+	uint16_t GridHeight;
+	uint32_t TurnSeconds;
+	bool SimultaneousTurns;
+	uint32_t Turn;
+	uint8_t TurnPlayerID;
+	uint64_t Seed;
+	uint64_t RandomState[4];
+	uint64_t GridHash;
+	uint32_t PlayerCount;
+	uint32_t FieldCount;
+	uint32_t FoodCount;
+};
+
+struct CheckpointPlayer
+{
+	uint8_t ID;
+	bool HasLostGame;
+	char IP[CHECKPOINT_IP_LENGTH];
+	char Name[CHECKPOINT_NAME_LENGTH];
+	uint64_t SessionToken;
+	uint32_t Sequence;
+};
+
+struct CheckpointField
+{
+	uint16_t x;
+	uint16_t y;
+	uint8_t FieldType;
+	uint8_t OwnerID;
+	int16_t Power;
+};
+#pragma pack(pop)
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Serializer.h"
 #include "Instruction.h"
 #include "DynamicBuffer.h"
+#include "RateLimiter.h"
 
 #define BUFFER_SIZE 512
 
@@ -33,4 +34,5 @@ public:
     SOCKET m_Socket;
     Serializer m_Serializer;
     DynamicBuffer m_ReceiveBuffer = DynamicBuffer(BUFFER_SIZE);
+    RateState m_Rate;
 };
\ No newline at end of file
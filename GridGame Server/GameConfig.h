@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include "Grid.h"
+
+struct GameConfig
+{
+	uint16_t m_GridWidth = GRID_DEFAULT_SIZE;
+	uint16_t m_GridHeight = GRID_DEFAULT_SIZE;
+	uint32_t m_TurnSeconds = 10;
+	bool m_SimultaneousTurns = false;
+	uint64_t m_Seed = 0;
+	std::string m_LogDirectory;
+	std::string m_CheckpointDirectory;
+	uint32_t m_CheckpointTurns = 10;
+	bool m_SendGridHash = false;
+	uint32_t m_AIPlayers = 0;
+	uint32_t m_AIFillSeconds = 15;
+	uint32_t m_AIBudgetMs = 250;
+	uint32_t m_AIThreads = 0;
+	std::string m_TraceDirectory;
+	uint32_t m_TraceSlowTurnMs = 0;
+};
\ No newline at end of file
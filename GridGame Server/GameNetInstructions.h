@@ -1,15 +1,26 @@
 #pragma once
+#include <map>
+#include "Packet.h"
 #include "Instruction.h"
 
-Instruction Connect = {
+#define GRID_MAX_BATCH_MOVES 4096
+
+inline Instruction Connect = {
 		InstructionType::TYPE_STRING,         // Name
 };
 
-Instruction ConnectAck = {
+inline Instruction ConnectAck = {
 	InstructionType::TYPE_UINT8,          // Player ID
+	InstructionType::TYPE_UINT64,         // Session token
+};
+
+// Resume a session after the connection was lost
+inline Instruction Reconnect = {
+	InstructionType::TYPE_UINT64,         // Session token
+	InstructionType::TYPE_UINT32,         // Last received sequence
 };
 
-Instruction GameStart = {
+inline Instruction GameStart = {
 	InstructionType::TYPE_UINT16,         // Grid width
 	InstructionType::TYPE_UINT16,         // Grid height
 	InstructionStructure {                // Players[]
@@ -20,7 +31,7 @@ Instruction GameStart = {
 	},
 };
 
-Instruction Move = {
+inline Instruction Move = {
 	InstructionType::TYPE_BOOL,           // Should split
 	InstructionType::TYPE_UINT16,         // From X
 	InstructionType::TYPE_UINT16,         // From Y
@@ -28,11 +39,33 @@ Instruction Move = {
 	InstructionType::TYPE_UINT16,         // To Y
 };
 
-Instruction Broadcast = {
+inline Instruction Broadcast = {
 	InstructionType::TYPE_STRING,         // Message
 };
 
-Instruction GameData = {
+inline Instruction GameData = {
+	InstructionType::TYPE_UINT8,          // Turn player ID
+	InstructionType::TYPE_INT64,          // Time epoch move timeout
+	InstructionStructure {                // Updated fields[]
+		{
+			InstructionType::TYPE_UINT16,  // X
+			InstructionType::TYPE_UINT16,  // Y
+			InstructionType::TYPE_UINT8,  // Type ID
+			InstructionType::TYPE_UINT8,  // Owner ID
+			InstructionType::TYPE_INT16   // Power
+		}
+	},
+	InstructionStructure {                // Next food spawns[]
+		{
+			InstructionType::TYPE_UINT16,  // X
+			InstructionType::TYPE_UINT16,  // Y
+		}
+	},
+	InstructionType::TYPE_UINT32,         // Sequence
+};
+
+// Game data followed by the hash of the whole grid, for clients verifying their state
+inline Instruction GameDataHashed = {
 	InstructionType::TYPE_UINT8,          // Turn player ID
 	InstructionType::TYPE_INT64,          // Time epoch move timeout
 	InstructionStructure {                // Updated fields[]
@@ -49,5 +82,49 @@ Instruction GameData = {
 			InstructionType::TYPE_UINT16,  // X
 			InstructionType::TYPE_UINT16,  // Y
 		}
-	}
-};
\ No newline at end of file
+	},
+	InstructionType::TYPE_UINT32,         // Sequence
+	InstructionType::TYPE_UINT64,         // Grid hash
+};
+
+// Longer batches are rejected while decoding, before they are parsed
+inline Instruction MoveBatch = {
+	InstructionStructure {                // Moves[]
+		{
+			InstructionType::TYPE_BOOL,    // Should split
+			InstructionType::TYPE_UINT16,  // From X
+			InstructionType::TYPE_UINT16,  // From Y
+			InstructionType::TYPE_UINT16,  // To X
+			InstructionType::TYPE_UINT16,  // To Y
+		},
+		GRID_MAX_BATCH_MOVES
+	},
+};
+
+inline Instruction MoveBatchResult = {
+	InstructionType::TYPE_UINT16,         // Accepted moves
+	InstructionStructure {                // Rejected moves[]
+		{
+			InstructionType::TYPE_UINT16,  // Index in batch
+			InstructionType::TYPE_UINT8,   // Reason
+		}
+	},
+};
+
+// Full protocol for tools speaking to the server directly
+inline void GetGameInstructions(std::map<NetDataType, Instruction>* pInstructions)
+{
+	(*pInstructions)[NetDataType::NET_CONNECT] = Connect;
+	(*pInstructions)[NetDataType::NET_CONNECT_ACK] = ConnectAck;
+	(*pInstructions)[NetDataType::NET_LEAVE] = Instruction();
+	(*pInstructions)[NetDataType::NET_MOVE] = Move;
+	(*pInstructions)[NetDataType::NET_END_TURN] = Instruction();
+	(*pInstructions)[NetDataType::NET_BROADCAST] = Broadcast;
+	(*pInstructions)[NetDataType::NET_GAME_START] = GameStart;
+	(*pInstructions)[NetDataType::NET_GAME_DATA] = GameData;
+	(*pInstructions)[NetDataType::NET_MOVE_BATCH] = MoveBatch;
+	(*pInstructions)[NetDataType::NET_MOVE_BATCH_RESULT] = MoveBatchResult;
+	(*pInstructions)[NetDataType::NET_GAME_DATA_HASHED] = GameDataHashed;
+	(*pInstructions)[NetDataType::NET_SPECTATE] = Instruction();
+	(*pInstructions)[NetDataType::NET_RECONNECT] = Reconnect;
+}
\ No newline at end of file
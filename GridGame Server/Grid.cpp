@@ -0,0 +1,507 @@
+#include <bit>
+#include <algorithm>
+#include "Grid.h"
+
+static const Field s_EmptyField = Field();
+
+Chunk::Chunk()
+{
+	m_Fields.fill(Field());
+	m_Workers.fill(0);
+	m_FoodCount = 0;
+}
+
+GridArena::GridArena()
+	: m_Buffer(GRID_ARENA_SIZE)
+{
+}
+
+void* GridArena::do_allocate(std::size_t Bytes, std::size_t Alignment)
+{
+	// Only the game thread writes to the grid, parallel move resolution just reads it
+	return m_Buffer.allocate(Bytes, Alignment);
+}
+
+void GridArena::do_deallocate(void* p, std::size_t Bytes, std::size_t Alignment)
+{
+	// Snapshots keep old chunks for the whole match anyway, nothing is reused
+}
+
+bool GridArena::do_is_equal(const std::pmr::memory_resource& Other) const noexcept
+{
+	return this == &Other;
+}
+
+GridSnapshot::GridSnapshot()
+{
+	m_Width = 0;
+	m_Height = 0;
+	m_ChunksX = 0;
+	m_Hash = 0;
+}
+
+GridSnapshot& GridSnapshot::operator=(const GridSnapshot& Other)
+{
+	return *this = GridSnapshot(Other);
+}
+
+GridSnapshot& GridSnapshot::operator=(GridSnapshot&& Other)
+{
+	// The old pages are released before the arena they were allocated from
+	m_Pages = std::move(Other.m_Pages);
+	m_pArena = std::move(Other.m_pArena);
+	m_Width = Other.m_Width;
+	m_Height = Other.m_Height;
+	m_ChunksX = Other.m_ChunksX;
+	m_Hash = Other.m_Hash;
+
+	return *this;
+}
+
+const Field& GridSnapshot::Get(uint16_t x, uint16_t y) const
+{
+	const Chunk* pChunk = GetChunk((y / GRID_CHUNK_SIZE) * m_ChunksX + (x / GRID_CHUNK_SIZE));
+
+	if (!pChunk)
+		return s_EmptyField;
+
+	return pChunk->m_Fields[(y % GRID_CHUNK_SIZE) * GRID_CHUNK_SIZE + (x % GRID_CHUNK_SIZE)];
+}
+
+const Chunk* GridSnapshot::GetChunk(uint32_t ChunkIndex) const
+{
+	const ChunkPage* pPage = m_Pages[ChunkIndex / GRID_PAGE_CHUNKS].get();
+
+	return pPage ? pPage->m_Chunks[ChunkIndex % GRID_PAGE_CHUNKS].get() : nullptr;
+}
+
+uint16_t GridSnapshot::GetWidth() const
+{
+	return m_Width;
+}
+
+uint16_t GridSnapshot::GetHeight() const
+{
+	return m_Height;
+}
+
+Grid::Grid() : Grid(GRID_DEFAULT_SIZE, GRID_DEFAULT_SIZE)
+{
+}
+
+Grid::Grid(uint16_t Width, uint16_t Height)
+{
+	m_Width = std::clamp<uint16_t>(Width, 1, GRID_MAX_SIZE);
+	m_Height = std::clamp<uint16_t>(Height, 1, GRID_MAX_SIZE);
+	m_ChunksX = (m_Width + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE;
+	m_ChunksY = (m_Height + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE;
+
+	Clear();
+}
+
+Grid& Grid::operator=(const Grid& Other)
+{
+	return *this = Grid(Other);
+}
+
+Grid& Grid::operator=(Grid&& Other)
+{
+	// The old pages are released before the arena they were allocated from
+	m_Pages = std::move(Other.m_Pages);
+	m_pArena = std::move(Other.m_pArena);
+	m_Width = Other.m_Width;
+	m_Height = Other.m_Height;
+	m_ChunksX = Other.m_ChunksX;
+	m_ChunksY = Other.m_ChunksY;
+	m_FoodCount = Other.m_FoodCount;
+	m_Hash = Other.m_Hash;
+	m_WorkerCount = Other.m_WorkerCount;
+	m_OwnerChunks = std::move(Other.m_OwnerChunks);
+	m_OccupiedBits = std::move(Other.m_OccupiedBits);
+	m_MovedBits = std::move(Other.m_MovedBits);
+	m_OwnerBits = std::move(Other.m_OwnerBits);
+	m_DirtyChunks = std::move(Other.m_DirtyChunks);
+	m_DirtyFields = std::move(Other.m_DirtyFields);
+
+	return *this;
+}
+
+void Grid::Clear()
+{
+	// Drop all chunks, they get allocated again when first occupied
+	m_Pages.clear();
+
+	// Snapshots still holding chunks keep the previous arena alive
+	m_pArena = std::make_shared<GridArena>();
+	m_Pages.resize((GetChunkCount() + GRID_PAGE_CHUNKS - 1) / GRID_PAGE_CHUNKS);
+
+	// Dirty bits per field, and per chunk to skip clean chunks quickly
+	m_DirtyChunks.assign((GetChunkCount() + 63) / 64, 0);
+	m_DirtyFields.assign(GetChunkCount() * GRID_DIRTY_WORDS, 0);
+
+	for (auto& Chunks : m_OwnerChunks)
+		Chunks.clear();
+
+	m_WorkerCount.fill(0);
+	m_FoodCount = 0;
+	m_Hash = 0;
+
+	// Bit planes of the rules, their tiles also get allocated when first occupied
+	m_OccupiedBits.Resize(m_Width, m_Height);
+	m_MovedBits.Resize(m_Width, m_Height);
+
+	for (Bitboard& Bits : m_OwnerBits)
+		Bits.Resize(m_Width, m_Height);
+}
+
+const Field& Grid::Get(uint16_t x, uint16_t y) const
+{
+	const Chunk* pChunk = GetChunk(GetChunkIndex(x, y));
+
+	if (!pChunk)
+		return s_EmptyField;
+
+	return pChunk->m_Fields[(y % GRID_CHUNK_SIZE) * GRID_CHUNK_SIZE + (x % GRID_CHUNK_SIZE)];
+}
+
+void Grid::Set(uint16_t x, uint16_t y, const Field& NewField)
+{
+	uint32_t ChunkIndex = GetChunkIndex(x, y);
+
+	// Writing nothing into an unallocated chunk
+	if (!GetChunk(ChunkIndex) && NewField.m_FieldType == Field::FieldType::FIELD_EMPTY)
+		return;
+
+	Chunk* pChunk = GetWritableChunk(ChunkIndex);
+	uint32_t FieldIndex = (y % GRID_CHUNK_SIZE) * GRID_CHUNK_SIZE + (x % GRID_CHUNK_SIZE);
+	Field* pField = &pChunk->m_Fields[FieldIndex];
+
+	// Mark field as changed this turn
+	MarkDirty(ChunkIndex, FieldIndex);
+	UpdateBits(x, y, *pField, NewField);
+
+	// Swap the old field out of the hash and the new one in
+	m_Hash ^= HashField(x, y, *pField) ^ HashField(x, y, NewField);
+
+	// Remove old field from spatial index
+	if (pField->m_FieldType == Field::FieldType::FIELD_FOOD)
+	{
+		pChunk->m_FoodCount--;
+		m_FoodCount--;
+	}
+	else if (pField->m_FieldType == Field::FieldType::FIELD_WORKER && pField->m_OwnerID != FIELD_NO_OWNER)
+	{
+		m_WorkerCount[pField->m_OwnerID]--;
+
+		if (--pChunk->m_Workers[pField->m_OwnerID] == 0)
+		{
+			std::vector<uint32_t>& Chunks = m_OwnerChunks[pField->m_OwnerID];
+			Chunks.erase(std::find(Chunks.begin(), Chunks.end(), ChunkIndex));
+		}
+	}
+
+	*pField = NewField;
+
+	// Add new field to spatial index
+	if (pField->m_FieldType == Field::FieldType::FIELD_FOOD)
+	{
+		pChunk->m_FoodCount++;
+		m_FoodCount++;
+	}
+	else if (pField->m_FieldType == Field::FieldType::FIELD_WORKER && pField->m_OwnerID != FIELD_NO_OWNER)
+	{
+		m_WorkerCount[pField->m_OwnerID]++;
+
+		if (pChunk->m_Workers[pField->m_OwnerID]++ == 0)
+			m_OwnerChunks[pField->m_OwnerID].push_back(ChunkIndex);
+	}
+}
+
+void Grid::ClearMoved()
+{
+	// Only fields changed this turn can have moved, leave all other chunks shared
+	for (uint32_t ChunkWord = 0; ChunkWord < m_DirtyChunks.size(); ChunkWord++)
+	{
+		uint64_t ChunkBits = m_DirtyChunks[ChunkWord];
+
+		while (ChunkBits)
+		{
+			uint32_t ChunkIndex = ChunkWord * 64 + std::countr_zero(ChunkBits);
+			ChunkBits &= ChunkBits - 1;
+
+			const Chunk* pChunk = GetChunk(ChunkIndex);
+
+			if (!pChunk || std::none_of(pChunk->m_Fields.begin(), pChunk->m_Fields.end(), [](const Field& Field) { return Field.m_WasMoved; }))
+				continue;
+
+			for (Field& Field : GetWritableChunk(ChunkIndex)->m_Fields)
+				Field.m_WasMoved = false;
+		}
+	}
+
+	m_MovedBits.Clear();
+}
+
+void Grid::CollectUpdates(std::vector<FieldUpdate>* pUpdates)
+{
+	pUpdates->clear();
+
+	// Count changed fields first to allocate only once
+	std::size_t DirtyCount = 0;
+
+	for (uint64_t Bits : m_DirtyFields)
+		DirtyCount += std::popcount(Bits);
+
+	pUpdates->reserve(DirtyCount);
+
+	// Emit the final state of every changed field once, ordered by chunk and field
+	for (uint32_t ChunkWord = 0; ChunkWord < m_DirtyChunks.size(); ChunkWord++)
+	{
+		uint64_t ChunkBits = m_DirtyChunks[ChunkWord];
+
+		while (ChunkBits)
+		{
+			uint32_t ChunkIndex = ChunkWord * 64 + std::countr_zero(ChunkBits);
+			ChunkBits &= ChunkBits - 1;
+
+			const Chunk* pChunk = GetChunk(ChunkIndex);
+			uint16_t ChunkX = (ChunkIndex % m_ChunksX) * GRID_CHUNK_SIZE;
+			uint16_t ChunkY = (ChunkIndex / m_ChunksX) * GRID_CHUNK_SIZE;
+
+			for (uint32_t Word = 0; Word < GRID_DIRTY_WORDS; Word++)
+			{
+				uint64_t& FieldBits = m_DirtyFields[ChunkIndex * GRID_DIRTY_WORDS + Word];
+
+				while (FieldBits)
+				{
+					uint32_t FieldIndex = Word * 64 + std::countr_zero(FieldBits);
+					FieldBits &= FieldBits - 1;
+
+					pUpdates->push_back(
+						FieldUpdate(
+							(uint16_t)(ChunkX + FieldIndex % GRID_CHUNK_SIZE),
+							(uint16_t)(ChunkY + FieldIndex / GRID_CHUNK_SIZE),
+							pChunk ? pChunk->m_Fields[FieldIndex] : s_EmptyField
+						)
+					);
+				}
+			}
+		}
+
+		m_DirtyChunks[ChunkWord] = 0;
+	}
+}
+
+void Grid::Restore(const GridSnapshot& Snapshot)
+{
+	// Resend every chunk which differs from the snapshot
+	for (uint32_t ChunkIndex = 0; ChunkIndex < GetChunkCount(); ChunkIndex++)
+	{
+		if (GetChunk(ChunkIndex) == Snapshot.GetChunk(ChunkIndex))
+			continue;
+
+		for (uint32_t FieldIndex = 0; FieldIndex < GRID_CHUNK_FIELDS; FieldIndex++)
+			MarkDirty(ChunkIndex, FieldIndex);
+	}
+
+	// The old pages are released before the arena they were allocated from
+	m_Pages = Snapshot.m_Pages;
+	m_pArena = Snapshot.m_pArena;
+	m_Hash = Snapshot.m_Hash;
+
+	// Rebuild spatial index from the restored chunks
+	for (auto& Chunks : m_OwnerChunks)
+		Chunks.clear();
+
+	m_WorkerCount.fill(0);
+	m_FoodCount = 0;
+	m_OccupiedBits.Clear();
+	m_MovedBits.Clear();
+
+	for (Bitboard& Bits : m_OwnerBits)
+		Bits.Clear();
+
+	for (uint32_t ChunkIndex = 0; ChunkIndex < GetChunkCount(); ChunkIndex++)
+	{
+		const Chunk* pChunk = GetChunk(ChunkIndex);
+
+		if (!pChunk)
+			continue;
+
+		m_FoodCount += pChunk->m_FoodCount;
+
+		uint16_t ChunkX = (ChunkIndex % m_ChunksX) * GRID_CHUNK_SIZE;
+		uint16_t ChunkY = (ChunkIndex / m_ChunksX) * GRID_CHUNK_SIZE;
+
+		for (uint32_t FieldIndex = 0; FieldIndex < GRID_CHUNK_FIELDS; FieldIndex++)
+		{
+			if (pChunk->m_Fields[FieldIndex].m_FieldType != Field::FieldType::FIELD_EMPTY)
+				UpdateBits(ChunkX + FieldIndex % GRID_CHUNK_SIZE, ChunkY + FieldIndex / GRID_CHUNK_SIZE, s_EmptyField, pChunk->m_Fields[FieldIndex]);
+		}
+
+		for (uint32_t OwnerID = 0; OwnerID < GRID_MAX_OWNERS; OwnerID++)
+		{
+			if (!pChunk->m_Workers[OwnerID])
+				continue;
+
+			m_WorkerCount[OwnerID] += pChunk->m_Workers[OwnerID];
+			m_OwnerChunks[OwnerID].push_back(ChunkIndex);
+		}
+	}
+}
+
+GridSnapshot Grid::Snapshot() const
+{
+	GridSnapshot Snapshot;
+	Snapshot.m_Width = m_Width;
+	Snapshot.m_Height = m_Height;
+	Snapshot.m_ChunksX = m_ChunksX;
+	Snapshot.m_Hash = m_Hash;
+	Snapshot.m_pArena = m_pArena;
+	Snapshot.m_Pages = m_Pages;
+
+	return Snapshot;
+}
+
+std::pmr::memory_resource* Grid::GetArena() const
+{
+	return m_pArena.get();
+}
+
+const Chunk* Grid::GetChunk(uint32_t ChunkIndex) const
+{
+	const ChunkPage* pPage = m_Pages[ChunkIndex / GRID_PAGE_CHUNKS].get();
+
+	return pPage ? pPage->m_Chunks[ChunkIndex % GRID_PAGE_CHUNKS].get() : nullptr;
+}
+
+Chunk* Grid::GetWritableChunk(uint32_t ChunkIndex)
+{
+	std::shared_ptr<ChunkPage>& pPage = m_Pages[ChunkIndex / GRID_PAGE_CHUNKS];
+
+	std::pmr::polymorphic_allocator<Chunk> Allocator(GetArena());
+
+	// Copy page and chunk first if a snapshot still holds them
+	if (!pPage)
+		pPage = std::allocate_shared<ChunkPage>(Allocator);
+	else if (pPage.use_count() > 1)
+		pPage = std::allocate_shared<ChunkPage>(Allocator, *pPage);
+
+	std::shared_ptr<Chunk>& pChunk = pPage->m_Chunks[ChunkIndex % GRID_PAGE_CHUNKS];
+
+	if (!pChunk)
+		pChunk = std::allocate_shared<Chunk>(Allocator);
+	else if (pChunk.use_count() > 1)
+		pChunk = std::allocate_shared<Chunk>(Allocator, *pChunk);
+
+	return pChunk.get();
+}
+
+void Grid::MarkDirty(uint32_t ChunkIndex, uint32_t FieldIndex)
+{
+	m_DirtyChunks[ChunkIndex / 64] |= 1ull << (ChunkIndex % 64);
+	m_DirtyFields[ChunkIndex * GRID_DIRTY_WORDS + FieldIndex / 64] |= 1ull << (FieldIndex % 64);
+}
+
+void Grid::UpdateBits(uint16_t x, uint16_t y, const Field& OldField, const Field& NewField)
+{
+	if (OldField.m_FieldType == Field::FieldType::FIELD_WORKER && OldField.m_OwnerID != FIELD_NO_OWNER)
+		m_OwnerBits[OldField.m_OwnerID].Reset(x, y);
+
+	if (NewField.m_FieldType == Field::FieldType::FIELD_WORKER && NewField.m_OwnerID != FIELD_NO_OWNER)
+		m_OwnerBits[NewField.m_OwnerID].Set(x, y);
+
+	m_OccupiedBits.Assign(x, y, NewField.m_FieldType != Field::FieldType::FIELD_EMPTY);
+	m_MovedBits.Assign(x, y, NewField.m_WasMoved);
+}
+
+bool Grid::IsInside(int x, int y) const
+{
+	return x >= 0 && x < m_Width && y >= 0 && y < m_Height;
+}
+
+uint32_t Grid::GetChunkIndex(uint16_t x, uint16_t y) const
+{
+	return (y / GRID_CHUNK_SIZE) * m_ChunksX + (x / GRID_CHUNK_SIZE);
+}
+
+uint32_t Grid::GetChunkCount() const
+{
+	return (uint32_t)m_ChunksX * m_ChunksY;
+}
+
+uint16_t Grid::GetChunksX() const
+{
+	return m_ChunksX;
+}
+
+uint16_t Grid::GetChunksY() const
+{
+	return m_ChunksY;
+}
+
+uint16_t Grid::GetWidth() const
+{
+	return m_Width;
+}
+
+uint16_t Grid::GetHeight() const
+{
+	return m_Height;
+}
+
+uint32_t Grid::GetFoodCount() const
+{
+	return m_FoodCount;
+}
+
+uint32_t Grid::GetWorkerCount(uint8_t OwnerID) const
+{
+	return m_WorkerCount[OwnerID];
+}
+
+const std::vector<uint32_t>& Grid::GetOwnerChunks(uint8_t OwnerID) const
+{
+	return m_OwnerChunks[OwnerID];
+}
+
+const Bitboard& Grid::GetOccupiedBits() const
+{
+	return m_OccupiedBits;
+}
+
+const Bitboard& Grid::GetMovedBits() const
+{
+	return m_MovedBits;
+}
+
+const Bitboard& Grid::GetOwnerBits(uint8_t OwnerID) const
+{
+	return m_OwnerBits[OwnerID];
+}
+
+uint64_t Grid::GetHash() const
+{
+	return m_Hash;
+}
+
+uint64_t Grid::HashField(uint16_t x, uint16_t y, const Field& Field)
+{
+	// Empty fields are not part of the hash, so an empty grid hashes to 0
+	if (Field.m_FieldType == Field::FieldType::FIELD_EMPTY)
+		return 0;
+
+	// Zobrist key of the position and content, mixed on the fly instead of looked up in a table.
+	// The moved flag is left out, it is reset every turn and not part of the board state
+	uint64_t Key = ((uint64_t)y << 48) | ((uint64_t)x << 32) | ((uint64_t)Field.m_FieldType << 24) |
+		((uint64_t)Field.m_OwnerID << 16) | (uint16_t)Field.m_Power;
+
+	// splitmix64 finalizer
+	Key ^= Key >> 30;
+	Key *= 0xBF58476D1CE4E5B9ull;
+	Key ^= Key >> 27;
+	Key *= 0x94D049BB133111EBull;
+	Key ^= Key >> 31;
+
+	return Key;
+}
\ No newline at end of file
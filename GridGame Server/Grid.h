@@ -0,0 +1,129 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <vector>
+#include <memory_resource>
+#include "Field.h"
+#include "Bitboard.h"
+
+#define GRID_DEFAULT_SIZE 25
+#define GRID_MAX_SIZE 4096
+#define GRID_CHUNK_SIZE 32
+#define GRID_CHUNK_FIELDS (GRID_CHUNK_SIZE * GRID_CHUNK_SIZE)
+#define GRID_MAX_OWNERS 256
+#define GRID_VIEW_DISTANCE 32
+#define GRID_DIRTY_WORDS (GRID_CHUNK_FIELDS / 64)
+#define GRID_PAGE_CHUNKS 64
+#define GRID_ARENA_SIZE (1 << 20)
+
+struct Chunk
+{
+	Chunk();
+
+	std::array<Field, GRID_CHUNK_FIELDS> m_Fields;
+	std::array<uint16_t, GRID_MAX_OWNERS> m_Workers;
+	uint16_t m_FoodCount;
+};
+
+// Chunks are shared between the live grid and its snapshots and only copied when written
+struct ChunkPage
+{
+	std::array<std::shared_ptr<Chunk>, GRID_PAGE_CHUNKS> m_Chunks;
+};
+
+// Storage of one match, allocating is a pointer bump and everything is freed at once with the arena
+class GridArena : public std::pmr::memory_resource
+{
+public:
+	GridArena();
+
+private:
+	void* do_allocate(std::size_t Bytes, std::size_t Alignment) override;
+	void do_deallocate(void* p, std::size_t Bytes, std::size_t Alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& Other) const noexcept override;
+
+	std::pmr::monotonic_buffer_resource m_Buffer;
+};
+
+// Read only state of the grid at one point in time
+class GridSnapshot
+{
+public:
+	GridSnapshot();
+	GridSnapshot(const GridSnapshot& Other) = default;
+	GridSnapshot(GridSnapshot&& Other) = default;
+	GridSnapshot& operator=(const GridSnapshot& Other);
+	GridSnapshot& operator=(GridSnapshot&& Other);
+	const Field& Get(uint16_t x, uint16_t y) const;
+	const Chunk* GetChunk(uint32_t ChunkIndex) const;
+	uint16_t GetWidth() const;
+	uint16_t GetHeight() const;
+
+private:
+	friend class Grid;
+
+	uint16_t m_Width;
+	uint16_t m_Height;
+	uint16_t m_ChunksX;
+	uint64_t m_Hash;
+	std::shared_ptr<GridArena> m_pArena;
+	std::vector<std::shared_ptr<ChunkPage>> m_Pages;
+};
+
+class Grid
+{
+public:
+	Grid();
+	Grid(uint16_t Width, uint16_t Height);
+	Grid(const Grid& Other) = default;
+	Grid(Grid&& Other) = default;
+	Grid& operator=(const Grid& Other);
+	Grid& operator=(Grid&& Other);
+	void Clear();
+	void Set(uint16_t x, uint16_t y, const Field& NewField);
+	void ClearMoved();
+	void CollectUpdates(std::vector<FieldUpdate>* pUpdates);
+	void Restore(const GridSnapshot& Snapshot);
+	GridSnapshot Snapshot() const;
+	std::pmr::memory_resource* GetArena() const;
+
+	const Field& Get(uint16_t x, uint16_t y) const;
+	const Chunk* GetChunk(uint32_t ChunkIndex) const;
+	bool IsInside(int x, int y) const;
+	uint32_t GetChunkIndex(uint16_t x, uint16_t y) const;
+	uint32_t GetChunkCount() const;
+	uint16_t GetChunksX() const;
+	uint16_t GetChunksY() const;
+	uint16_t GetWidth() const;
+	uint16_t GetHeight() const;
+	uint32_t GetFoodCount() const;
+	uint32_t GetWorkerCount(uint8_t OwnerID) const;
+	const std::vector<uint32_t>& GetOwnerChunks(uint8_t OwnerID) const;
+	const Bitboard& GetOccupiedBits() const;
+	const Bitboard& GetMovedBits() const;
+	const Bitboard& GetOwnerBits(uint8_t OwnerID) const;
+	uint64_t GetHash() const;
+
+	static uint64_t HashField(uint16_t x, uint16_t y, const Field& Field);
+
+private:
+	Chunk* GetWritableChunk(uint32_t ChunkIndex);
+	void MarkDirty(uint32_t ChunkIndex, uint32_t FieldIndex);
+	void UpdateBits(uint16_t x, uint16_t y, const Field& OldField, const Field& NewField);
+
+	uint16_t m_Width;
+	uint16_t m_Height;
+	uint16_t m_ChunksX;
+	uint16_t m_ChunksY;
+	uint32_t m_FoodCount;
+	uint64_t m_Hash;
+	std::array<uint32_t, GRID_MAX_OWNERS> m_WorkerCount;
+	std::array<std::vector<uint32_t>, GRID_MAX_OWNERS> m_OwnerChunks;
+	Bitboard m_OccupiedBits;
+	Bitboard m_MovedBits;
+	std::array<Bitboard, GRID_MAX_OWNERS> m_OwnerBits;
+	std::shared_ptr<GridArena> m_pArena;
+	std::vector<std::shared_ptr<ChunkPage>> m_Pages;
+	std::vector<uint64_t> m_DirtyChunks;
+	std::vector<uint64_t> m_DirtyFields;
+};
\ No newline at end of file
@@ -2,35 +2,57 @@
 #include <chrono>
 #include <thread>
 #include <numeric>
-#include <iostream>
 #include <algorithm>
+#include <tuple>
+#include <unordered_map>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <cstring>
 #include "Server.h"
-#include "Utility.h"
+#include "Rules.h"
 #include "GridGame.h"
 #include "GameNetInstructions.h"
+#include "MappedFile.h"
+#include "Replay.h"
+#include "Metrics.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "Allocations.h"
 
 #undef max
 #undef min
 
 GridGame* g_pGridGame = nullptr;
 
-GridGame::GridGame(Server* pServer)
+TurnSnapshot::TurnSnapshot(uint8_t TurnPlayerID, const ::Random& Random, GridSnapshot Grid, const std::vector<FieldUpdate>& FutureFieldUpdates, std::pmr::memory_resource* pArena)
+	: TurnPlayerID(TurnPlayerID), Random(Random), Grid(std::move(Grid)), FutureFieldUpdates(FutureFieldUpdates.begin(), FutureFieldUpdates.end(), pArena)
 {
+}
+
+GridGame::GridGame(Server* pServer, GameConfig Config)
+	: m_TurnBuffer(GRID_TURN_ARENA_SIZE), m_TurnArena(m_TurnBuffer.data(), m_TurnBuffer.size()), m_Grid(Config.m_GridWidth, Config.m_GridHeight)
+{
+	m_Config = Config;
+	m_Turn = 0;
+	m_FirstHistoryTurn = 1;
+	m_CheckpointID = 0;
+	m_TurnPlayerID = FIELD_NO_OWNER;
 	m_NewGame = true;
 	m_TurnEnded = false;
 	m_GameRunning = false;
 	m_QueueStartTime = 0;
+	m_LobbyStartTime = 0;
 	m_TurnTimeout = 0;
-	m_GridWidth = 25;
-	m_GridHeight = 25;
+	m_TraceTurnStart = 0;
+	m_GridWidth = m_Grid.GetWidth();
+	m_GridHeight = m_Grid.GetHeight();
 	m_pServer = pServer;
+	m_pSink = pServer;
 
-	m_Grid.resize(m_GridWidth);
-
-	for (uint16_t x = 0; x < m_GridWidth; x++)
-	{
-		m_Grid[x].resize(m_GridHeight);
-	}
+	// Headless games (replays, simulations) run without a server
+	if (!m_pServer)
+		return;
 
 	m_pServer->RegisterInstruction(NetDataType::NET_CONNECT, Connect);
 	m_pServer->RegisterInstruction(NetDataType::NET_CONNECT_ACK, ConnectAck);
@@ -40,6 +62,13 @@ GridGame::GridGame(Server* pServer)
 	m_pServer->RegisterInstruction(NetDataType::NET_BROADCAST, Broadcast);
 	m_pServer->RegisterInstruction(NetDataType::NET_GAME_START, GameStart);
 	m_pServer->RegisterInstruction(NetDataType::NET_GAME_DATA, GameData);
+	m_pServer->RegisterInstruction(NetDataType::NET_MOVE_BATCH, MoveBatch);
+	m_pServer->RegisterInstruction(NetDataType::NET_MOVE_BATCH_RESULT, MoveBatchResult);
+	m_pServer->RegisterInstruction(NetDataType::NET_GAME_DATA_HASHED, GameDataHashed);
+	m_pServer->RegisterInstruction(NetDataType::NET_SPECTATE, Instruction());
+	m_pServer->RegisterInstruction(NetDataType::NET_RECONNECT, Reconnect);
+
+	m_Spectators.Start();
 }
 
 void GridGame::Routine()
@@ -48,6 +77,13 @@ void GridGame::Routine()
 	{
 		std::time_t Now = std::time(nullptr);
 
+		Metrics::Set(MetricGauge::GAUGE_MATCHES, m_GameRunning ? 1 : 0);
+		Metrics::Set(MetricGauge::GAUGE_PLAYERS, (int64_t)m_Players.size());
+
+		// Fill up queues short of humans with AI players
+		if (!m_GameRunning && m_Config.m_AIPlayers)
+			UpdateAIPlayers(Now);
+
 		// Reset queue if insufficient players
 		if (!m_GameRunning && m_Players.size() < 2)
 		{
@@ -66,39 +102,118 @@ void GridGame::Routine()
 		if (!m_GameRunning && Now - m_QueueStartTime > 5) // todo: add proper lobbies?
 		{
 			std::lock_guard LockGuard(m_Mutex);
-			StartGame();
-			PregenerateFood();
-			StartNewTurn();
-			Tick();
+			BeginMatch();
 		}
 
+		// AI players move right at the start of their turn
+		if (m_GameRunning && !m_TurnEnded && m_Config.m_AIPlayers)
+			PlayAITurns();
+
 		// Move time exceeded or new turn
 		if (m_GameRunning && (m_TurnEnded || Now >= m_TurnTimeout))
 		{
 			std::lock_guard LockGuard(m_Mutex);
-			PregenerateFood();
-			StartNewTurn();
-			Tick();
+			AdvanceTurn(!m_TurnEnded);
 		}
 
 		//std::this_thread::sleep_for(std::chrono::milliseconds(25));
 	}
 }
+
+void GridGame::BeginMatch()
+{
+	StartGame();
+	PregenerateFood();
+	StartNewTurn();
+	Tick();
+}
+
+void GridGame::AdvanceTurn(bool TimedOut)
+{
+	AllocationScope Allocations(AllocationSite::SITE_TURN);
+	uint64_t TurnStart = Metrics::GetTime();
+	uint64_t TraceStart = Trace::IsEnabled() ? Trace::GetTime() : 0;
+
+	if (m_Log.IsOpen())
+		m_Log.WriteTurn(TimedOut, m_Grid.GetHash());
+
+	// Resolve the moves of all players at once
+	if (m_Config.m_SimultaneousTurns)
+	{
+		ResolvePendingMoves();
+		FinishTurn();
+	}
+	// A timed out turn never went through HandleEndTurn, its workers would stay moved
+	else if (!m_TurnEnded)
+		FinishTurn();
+
+	PregenerateFood();
+	StartNewTurn();
+	Tick();
+
+	Metrics::Record(MetricHistogram::HISTOGRAM_TURN_NS, Metrics::GetTime() - TurnStart);
+
+	if (!TraceStart)
+		return;
+
+	uint64_t TraceEnd = Trace::GetTime();
+	Trace::Record("AdvanceTurn", TraceStart, TraceEnd);
+
+	// Keep the whole turn of a slow resolution, including the moves which led to it
+	if (m_Config.m_TraceSlowTurnMs && !m_Config.m_TraceDirectory.empty() && TraceEnd - TraceStart > m_Config.m_TraceSlowTurnMs * 1000000ull)
+		Trace::Dump(std::format("{}/trace_{}_turn_{}.json", m_Config.m_TraceDirectory, m_Random.GetSeed(), m_Turn - 1), 0, m_TraceTurnStart, TraceEnd);
+
+	m_TraceTurnStart = TraceEnd;
+}
+
+void GridGame::Send(const Packet& Packet, SOCKET Socket)
+{
+	if (!m_pSink || Socket >= GRID_AI_SOCKET_BASE)
+		return;
+
+	m_pSink->Send(Packet, Socket);
+}
+
+void GridGame::SetNetworkSink(NetworkSink* pSink)
+{
+	m_pSink = pSink;
+}
 void GridGame::StartGame()
 {
 	m_NewGame = true;
 	m_GameRunning = true;
 	m_QueueStartTime = 0;
+	m_Turn = 0;
+	m_PendingMoves.clear();
+	m_PendingOrigins.clear();
+	m_History.clear();
+	m_FirstHistoryTurn = 1;
+
+	// Seed the match, a fixed seed replays the same spawns
+	m_Random.SetSeed(m_Config.m_Seed ? m_Config.m_Seed : Random::GenerateSeed());
+	Logger::Write(LogLevel::LEVEL_INFO, "Match started with seed {}.", m_Random.GetSeed());
+	Trace::SetMatch(m_Random.GetSeed());
+	m_TraceTurnStart = Trace::GetTime();
+
+	// Start input log with the roster of this match
+	if (!m_Config.m_LogDirectory.empty() && m_Log.Open(std::format("{}/match_{}.log", m_Config.m_LogDirectory, m_Random.GetSeed())))
+	{
+		m_Log.WriteHeader(m_Config, m_Random.GetSeed());
+
+		for (const Player& Player : m_Players)
+			m_Log.WritePlayer(Player);
+	}
 
-	// Init grid
-	for (uint16_t x = 0; x < m_GridWidth; x++)
+	// Init grid, a recovered match may have left a board of another size
+	if (m_GridWidth != m_Config.m_GridWidth || m_GridHeight != m_Config.m_GridHeight)
 	{
-		for (uint16_t y = 0; y < m_GridHeight; y++)
-		{
-			m_Grid[x][y] = Field();
-		}
+		m_Grid = Grid(m_Config.m_GridWidth, m_Config.m_GridHeight);
+		m_GridWidth = m_Grid.GetWidth();
+		m_GridHeight = m_Grid.GetHeight();
 	}
 
+	m_Grid.Clear();
+
 	for (auto& Player : m_Players)
 	{
 		// Generate workers
@@ -106,40 +221,30 @@ void GridGame::StartGame()
 
 		do
 		{
-			x = Utility::GetRandomInteger<uint16_t>(0, m_GridWidth - 1);
-			y = Utility::GetRandomInteger<uint16_t>(0, m_GridHeight - 1);
+			m_Random.FillPositions(m_GridWidth, m_GridHeight, &x, &y, 1);
 
-		} while (m_Grid[x][y].m_FieldType != Field::FieldType::FIELD_EMPTY);
+		} while (m_Grid.Get(x, y).m_FieldType != Field::FieldType::FIELD_EMPTY);
 
 		// Add worker & prepare for submit to players
-		m_Grid[x][y] = Field(Field::FieldType::FIELD_WORKER, Player.second.m_ID, 5);
-		m_FieldUpdates.push_back(FieldUpdate(x, y, m_Grid[x][y]));
+		m_Grid.Set(x, y, Field(Field::FieldType::FIELD_WORKER, Player.m_ID, 5));
 
 		// Init Player
-		Player.second.m_WorkersAlive = 1;
-		Player.second.m_HasLostGame = false;
+		Player.m_WorkersAlive = 1;
+		Player.m_HasLostGame = false;
+		Player.m_Visible.Clear();
+		Player.m_Shown.Clear();
 
 		// Update player data
-		SendPlayerData(Player.second);
+		SendPlayerData(Player);
 	}
 }
 
 void GridGame::PregenerateFood()
 {
-	// Count amount of food on the field
-	int FoodCount = 0;
-
-	for (uint16_t x = 0; x < m_GridWidth; x++)
-	{
-		for (uint16_t y = 0; y < m_GridHeight; y++)
-		{
-			if (m_Grid[x][y].m_FieldType == Field::FieldType::FIELD_FOOD)
-				FoodCount++;
-		}
-	}
+	TraceScope Scope("PregenerateFood");
 
 	// Only respawn food if none left
-	if (FoodCount > 0)
+	if (m_Grid.GetFoodCount() > 0)
 		return;
 	
 	// Integrate Pregenerate food of last update
@@ -148,43 +253,46 @@ void GridGame::PregenerateFood()
 		if (Update.Field.m_FieldType != Field::FieldType::FIELD_FOOD)
 			continue;
 
-		Field* pField = &m_Grid[Update.x][Update.y];
+		Field Target = m_Grid.Get(Update.x, Update.y);
 
-		if (pField->m_FieldType == Field::FieldType::FIELD_WORKER)
+		if (Target.m_FieldType == Field::FieldType::FIELD_WORKER)
 		{
-			pField->m_Power += Update.Field.m_Power;
-			Update.Field = *pField;
+			Target.m_Power += Update.Field.m_Power;
+			Update.Field = Target;
 		}
 		else
 		{
-			*pField = Field(Field::FieldType::FIELD_FOOD, FIELD_NO_OWNER, 1);
-			m_FieldUpdates.push_back(FieldUpdate(Update.x, Update.y, *pField));
+			Target = Field(Field::FieldType::FIELD_FOOD, FIELD_NO_OWNER, 1);
 		}
+
+		m_Grid.Set(Update.x, Update.y, Target);
 	}
 
 	m_FutureFieldUpdates.clear();
 
 	// Pregenerate food for next update unless first turn
-	for (int i = 0; i < m_Players.size() * 2; i++)
+	std::size_t FoodCount = m_Players.size() * 2;
+	std::vector<uint16_t> FoodX(FoodCount);
+	std::vector<uint16_t> FoodY(FoodCount);
+
+	m_Random.FillPositions(m_GridWidth, m_GridHeight, FoodX.data(), FoodY.data(), FoodCount);
+
+	for (std::size_t i = 0; i < FoodCount; i++)
 	{
-		uint16_t x, y;
-		Field* pField = nullptr;
+		uint16_t& x = FoodX[i];
+		uint16_t& y = FoodY[i];
 
 		// If new game repeat until food doesn't spawn on worker
 		// TODO: Randomize only with empty fields
-		do
+		while (m_Grid.Get(x, y).m_FieldType != Field::FieldType::FIELD_EMPTY)
 		{
-			x = Utility::GetRandomInteger<uint16_t>(0, m_GridWidth - 1);
-			y = Utility::GetRandomInteger<uint16_t>(0, m_GridHeight - 1);
-			pField = &m_Grid[x][y];
+			m_Random.FillPositions(m_GridWidth, m_GridHeight, &x, &y, 1);
 		}
-		while (pField->m_FieldType != Field::FieldType::FIELD_EMPTY);
 
 		if (m_NewGame)
 		{
 			// Integrate to field directly
-			*pField = Field(Field::FieldType::FIELD_FOOD, FIELD_NO_OWNER, 1);
-			m_FieldUpdates.push_back(FieldUpdate(x, y, *pField));
+			m_Grid.Set(x, y, Field(Field::FieldType::FIELD_FOOD, FIELD_NO_OWNER, 1));
 		}
 		else 
 		{
@@ -198,15 +306,33 @@ void GridGame::PregenerateFood()
 void GridGame::Tick()
 {
 	// todo: receive client data in 1 thread 
+	uint64_t TickStart = Metrics::GetTime();
 	std::time_t Now = std::time(nullptr);
 
 	if (m_NewGame)
 	{
-		m_TurnTimeout = Now + 10;
+		m_TurnTimeout = Now + m_Config.m_TurnSeconds;
 		m_NewGame = false;
 	}
 
 	m_GameRunning = CheckWinConditions();
+
+	// Finish input log with the final state for replay verification
+	if (!m_GameRunning && m_Log.IsOpen())
+	{
+		m_Log.WriteEnd(m_Turn, m_Grid.GetHash());
+		m_Log.Close();
+	}
+
+	// Nothing left to recover
+	if (!m_GameRunning && !m_Config.m_CheckpointDirectory.empty())
+		RemoveCheckpoint();
+
+	// Spans of the finished match, older turns may have been overwritten already
+	if (!m_GameRunning && Trace::IsEnabled() && !m_Config.m_TraceDirectory.empty())
+		Trace::Dump(std::format("{}/trace_{}.json", m_Config.m_TraceDirectory, m_Random.GetSeed()), m_Random.GetSeed());
+
+	Metrics::Record(MetricHistogram::HISTOGRAM_TICK_NS, Metrics::GetTime() - TickStart);
 }
 
 bool GridGame::CheckWinConditions()
@@ -216,23 +342,20 @@ bool GridGame::CheckWinConditions()
 	// Check lost
 	for (auto& Player : m_Players)
 	{
-		if (!Player.second.m_HasLostGame && Player.second.m_WorkersAlive <= 0)
+		if (!Player.m_HasLostGame && Player.m_WorkersAlive <= 0)
 		{
-			Player.second.m_HasLostGame = true;
-			std::string Message = std::format("Player [{}] lost the game.", Player.second.m_Name);
+			Player.m_HasLostGame = true;
+			std::string Message = std::format("Player [{}] lost the game.", Player.m_Name);
 
 			Packet Broadcast(NetDataType::NET_BROADCAST);
 			Broadcast.push_back(Message);
 
-			m_pServer->GetSerializer()->SerializeSend(
-				Broadcast,
-				Player.second.m_Client.m_Socket
-			);
+			Send(Broadcast, Player.m_Socket);
 
-			std::cout << Message << std::endl;
+			Logger::Write(LogLevel::LEVEL_INFO, "Player [{}] lost the game.", Player.m_Name);
 		}
 
-		if (Player.second.m_HasLostGame)
+		if (Player.m_HasLostGame)
 			PlayersAlive--;
 	}
 
@@ -250,13 +373,10 @@ bool GridGame::CheckWinConditions()
 
 		for (auto& Player : m_Players)
 		{
-			m_pServer->GetSerializer()->SerializeSend(
-				Broadcast,
-				Player.second.m_Client.m_Socket
-			);
+			Send(Broadcast, Player.m_Socket);
 		}
 
-		std::cout << Message << std::endl;
+		Logger::Write(LogLevel::LEVEL_INFO, "The game ended in draw.");
 
 		return false;
 	}
@@ -266,19 +386,16 @@ bool GridGame::CheckWinConditions()
 	{
 		for (const auto& Player : m_Players)
 		{
-			if (Player.second.m_WorkersAlive > 0)
+			if (Player.m_WorkersAlive > 0)
 			{
-				std::string Message = std::format("Player [{}] has won the game.", Player.second.m_Name);
+				std::string Message = std::format("Player [{}] has won the game.", Player.m_Name);
 
 				Packet Broadcast(NetDataType::NET_BROADCAST);
 				Broadcast.push_back(Message);
 
-				m_pServer->GetSerializer()->SerializeSend(
-					Broadcast,
-					Player.second.m_Client.m_Socket
-				);
+				Send(Broadcast, Player.m_Socket);
 
-				std::cout << Message << std::endl;
+				Logger::Write(LogLevel::LEVEL_INFO, "Player [{}] has won the game.", Player.m_Name);
 			}
 		}
 
@@ -290,70 +407,224 @@ bool GridGame::CheckWinConditions()
 
 void GridGame::StartNewTurn()
 {
+	TraceScope Scope("StartNewTurn");
+
+	// Scratch of the previous turn is gone, its packets were handed to the sink already
+	m_TurnArena.release();
+
 	// Increment turn player
-	PlayerIterator PlayerNextIt;
-	PlayerIterator PlayerIt = GetPlayerByClient(m_TurnPlayer.m_Client);
+	Player* pNextPlayer = m_Players.GetNext(m_TurnPlayerID);
+	m_TurnPlayerID = pNextPlayer ? pNextPlayer->m_ID : FIELD_NO_OWNER;
+	m_TurnTimeout = std::time(nullptr) + m_Config.m_TurnSeconds;
+	m_Turn++;
 
-	if (PlayerIt == m_Players.end())
-		PlayerNextIt = m_Players.begin();
-	else
-		PlayerNextIt = std::next(PlayerIt, 1);
-	
-	if (PlayerNextIt == m_Players.end())
-		PlayerNextIt = m_Players.begin();
+	for (auto& Player : m_Players)
+	{
+		Player.m_HasEndedTurn = false;
+	}
 
-	m_TurnPlayer = PlayerNextIt->second;
-	m_TurnTimeout = std::time(nullptr) + 10;
+	// Gather every field changed since the last turn once
+	m_Grid.CollectUpdates(&m_FieldUpdates);
 
 	// Send updated grid data to players
-	for (const auto& Player : m_Players)
 	{
-		SendClientUpdate(Player.second);
+		AllocationScope Allocations(AllocationSite::SITE_BROADCAST);
+
+		for (auto& Player : m_Players)
+		{
+			SendClientUpdate(Player);
+		}
+
+		PublishSpectatorTurn(m_Turn == 1);
 	}
 
 	m_TurnEnded = false;
 	m_FieldUpdates.clear();
+
+	// Keep the start of every turn, unchanged chunks are shared with the previous turns
+	m_History.push_back(TurnSnapshot(m_TurnPlayerID, m_Random, m_Grid.Snapshot(), m_FutureFieldUpdates, m_Grid.GetArena()));
+
+	if (!m_Config.m_CheckpointDirectory.empty() && m_Config.m_CheckpointTurns && (m_Turn - 1) % m_Config.m_CheckpointTurns == 0)
+		SaveCheckpoint();
 }
 
-void GridGame::HandleEndTurn(PlayerIterator PlayerIt)
+void GridGame::PublishSpectatorTurn(bool Keyframe)
 {
-	if (PlayerIt->second != m_TurnPlayer)
+	if (!m_pServer)
 		return;
 
-	// Reset worker count
-	for (auto& Player : m_Players)
+	SpectatorTurn Turn;
+	Turn.Keyframe = Keyframe;
+	Turn.TurnPlayerID = m_Config.m_SimultaneousTurns ? (uint8_t)FIELD_NO_OWNER : m_TurnPlayerID;
+	Turn.TurnTimeout = m_TurnTimeout;
+	Turn.Turn = m_Turn;
+	Turn.Grid = m_Grid.Snapshot();
+
+	std::vector<PacketStruct> Players;
+	for (const Player& Player : m_Players)
+	{
+		Players.push_back(
+			{
+				(uint8_t)Player.m_ID,
+				(std::string)Player.m_Name,
+			}
+		);
+	}
+
+	Turn.Start = Packet(NetDataType::NET_GAME_START);
+	Turn.Start.push_back(m_GridWidth);
+	Turn.Start.push_back(m_GridHeight);
+	Turn.Start.push_back(Players);
+
+	for (const FieldUpdate& Update : m_FutureFieldUpdates)
 	{
-		Player.second.m_WorkersAlive = 0;
+		if (Update.Field.m_FieldType != Field::FieldType::FIELD_FOOD)
+			continue;
+
+		Turn.Food.push_back(
+			{
+				(uint16_t)Update.x,
+				(uint16_t)Update.y,
+			}
+		);
 	}
 
-	for (uint16_t x = 0; x < m_GridWidth; x++)
+	// Nobody watches, the snapshot is only kept for a viewer joining later
+	if (m_Spectators.HasSpectators())
 	{
-		for (uint16_t y = 0; y < m_GridHeight; y++)
+		for (const FieldUpdate& Update : m_FieldUpdates)
 		{
-			Field* pField = &m_Grid[x][y];
+			Turn.Changes.push_back(
+				{
+					(uint16_t)Update.x,
+					(uint16_t)Update.y,
+					(uint8_t)Update.Field.m_FieldType,
+					(uint8_t)Update.Field.m_OwnerID,
+					(uint16_t)Update.Field.m_Power
+				}
+			);
+		}
+	}
+
+	m_Spectators.Publish(std::move(Turn));
+}
+
+bool GridGame::RollbackToTurn(uint32_t Turn)
+{
+	std::lock_guard LockGuard(m_Mutex);
+
+	if (!m_GameRunning || Turn < m_FirstHistoryTurn || Turn - m_FirstHistoryTurn >= m_History.size())
+		return false;
+
+	if (m_Log.IsOpen())
+		m_Log.WriteRollback(Turn);
+
+	const TurnSnapshot& Snapshot = m_History[Turn - m_FirstHistoryTurn];
+
+	m_Grid.Restore(Snapshot.Grid);
+	m_Random = Snapshot.Random;
+	m_FutureFieldUpdates.assign(Snapshot.FutureFieldUpdates.begin(), Snapshot.FutureFieldUpdates.end());
+	m_TurnPlayerID = Snapshot.TurnPlayerID;
+	m_TurnTimeout = std::time(nullptr) + m_Config.m_TurnSeconds;
+	m_TurnEnded = false;
+	m_Turn = Turn;
+	m_PendingMoves.clear();
+	m_PendingOrigins.clear();
 
-			// Reset field
-			pField->m_WasMoved = false;
+	for (auto& Player : m_Players)
+	{
+		Player.m_WorkersAlive = m_Grid.GetWorkerCount(Player.m_ID);
+		Player.m_HasLostGame = Player.m_WorkersAlive == 0;
+		Player.m_HasEndedTurn = false;
+	}
+
+	// Send the restored grid to players
+	m_Grid.CollectUpdates(&m_FieldUpdates);
+
+	for (auto& Player : m_Players)
+	{
+		SendClientUpdate(Player);
+	}
+
+	PublishSpectatorTurn(true);
+
+	m_FieldUpdates.clear();
+
+	// Snapshots are never assigned, their food lists stay in the arena they were built in
+	while (m_History.size() > Turn - m_FirstHistoryTurn + 1)
+		m_History.pop_back();
+
+	return true;
+}
+
+bool GridGame::GetTurnSnapshot(uint32_t Turn, GridSnapshot* pSnapshot)
+{
+	std::lock_guard LockGuard(m_Mutex);
 
-			// Set new worker count
-			if (pField->m_FieldType == Field::FieldType::FIELD_WORKER && pField->m_OwnerID != FIELD_NO_OWNER)
-				m_Players[pField->m_OwnerID].m_WorkersAlive++;
+	if (Turn < m_FirstHistoryTurn || Turn - m_FirstHistoryTurn >= m_History.size())
+		return false;
+
+	*pSnapshot = m_History[Turn - m_FirstHistoryTurn].Grid;
+
+	return true;
+}
+
+void GridGame::HandleEndTurn(Player* pPlayer)
+{
+	TraceScope Scope("HandleEndTurn");
+
+	if (m_Config.m_SimultaneousTurns)
+	{
+		if (m_Log.IsOpen())
+			m_Log.WriteEndTurn(pPlayer->m_Socket);
+
+		pPlayer->m_HasEndedTurn = true;
+
+		// Close the window early once every active player is done
+		m_TurnEnded = true;
+
+		for (const Player& Player : m_Players)
+		{
+			if (!Player.m_HasEndedTurn && !Player.m_HasLostGame && !Player.m_HasLostConnection)
+				m_TurnEnded = false;
 		}
+
+		return;
 	}
 
+	if (pPlayer->m_ID != m_TurnPlayerID)
+		return;
+
+	if (m_Log.IsOpen())
+		m_Log.WriteEndTurn(pPlayer->m_Socket);
+
+	FinishTurn();
+
 	m_TurnEnded = true;
 }
 
-void GridGame::SendPlayerData(Player APlayer)
+void GridGame::FinishTurn()
+{
+	// Set new worker count
+	for (auto& Player : m_Players)
+	{
+		Player.m_WorkersAlive = m_Grid.GetWorkerCount(Player.m_ID);
+	}
+
+	// Reset fields
+	m_Grid.ClearMoved();
+}
+
+void GridGame::SendPlayerData(const Player& APlayer)
 {
 	// Send other players data to player
 	std::vector<PacketStruct> Players;
-	for (const std::pair<uint8_t, Player>& Player : m_Players)
+	for (const Player& Player : m_Players)
 	{
 		Players.push_back(
 			{
-				(uint8_t)Player.second.m_ID,
-				(std::string)Player.second.m_Name,
+				(uint8_t)Player.m_ID,
+				(std::string)Player.m_Name,
 			}
 		);
 	}
@@ -363,65 +634,146 @@ void GridGame::SendPlayerData(Player APlayer)
 	Packet.push_back(m_GridHeight);
 	Packet.push_back(Players);
 
-	m_pServer->GetSerializer()->SerializeSend(
-		Packet,
-		APlayer.m_Client.m_Socket
-	);
+	Send(Packet, APlayer.m_Socket);
 }
 
-void GridGame::SendClientUpdate(Player APlayer)
+void GridGame::SendClientUpdate(Player& APlayer)
 {
-	std::vector<PacketStruct> FoodUpdates;
-	std::vector<PacketStruct> FieldUpdates;
+	TraceScope Scope("SendClientUpdate");
 
-	for (const FieldUpdate& Update : m_FutureFieldUpdates)
+	UpdateMode Mode = m_pSink && APlayer.m_Socket < GRID_AI_SOCKET_BASE ? m_pSink->GetUpdateMode(APlayer.m_Socket) : UpdateMode::UPDATE_DELTA;
+
+	// A client far behind skips turns until its queue drained, then gets a keyframe
+	if (Mode == UpdateMode::UPDATE_SKIP)
+		return;
+
+	// Fields the client shows as occupied, sized with its first update
+	if (APlayer.m_Shown.GetWidth() != m_GridWidth || APlayer.m_Shown.GetHeight() != m_GridHeight)
+		APlayer.m_Shown.Resize(m_GridWidth, m_GridHeight);
+
+	// Its updates were dropped, so start over like a spectator joining with the roster and every visible field
+	if (Mode == UpdateMode::UPDATE_KEYFRAME)
 	{
-		if (Update.Field.m_FieldType != Field::FieldType::FIELD_FOOD)
-			continue;
+		SendPlayerData(APlayer);
+		APlayer.m_Visible.Clear();
+		APlayer.m_Shown.Fill();
+	}
 
-		FoodUpdates.push_back(
-			{
-				(uint16_t)Update.x,
-				(uint16_t)Update.y,
-			}
-		);
+	// Players who lost watch the whole grid
+	if (APlayer.m_HasLostGame)
+	{
+		m_Visible.Resize(m_GridWidth, m_GridHeight);
+		m_Visible.Fill();
 	}
+	else
+		Rules::GetVisible(m_Grid, APlayer.m_ID, &m_Visible);
+
+	// Fields which just came into view and are occupied, or were vacated while the client couldn't see them
+	m_Occupied = m_Grid.GetOccupiedBits();
+	m_Occupied.Or(APlayer.m_Shown);
+
+	m_NewlyVisible = m_Visible;
+	m_NewlyVisible.AndNot(APlayer.m_Visible);
+	m_NewlyVisible.And(m_Occupied);
+
+	// Fields are written straight into the packet, its data lives in the scratch of this turn
+	Packet Packet(m_Config.m_SendGridHash ? NetDataType::NET_GAME_DATA_HASHED : NetDataType::NET_GAME_DATA, &m_TurnArena);
+	Packet.m_Data.reserve(6 + (m_NewlyVisible.Count() + m_FieldUpdates.size()) * 5 + m_FutureFieldUpdates.size() * 2);
+	Packet.push_back(m_Config.m_SimultaneousTurns ? (uint8_t)FIELD_NO_OWNER : m_TurnPlayerID);
+	Packet.push_back(m_TurnTimeout);
+
+	std::size_t CountIndex = Packet.BeginStructs();
+	uint32_t Count = 0;
 
+	// Send whole content of occupied fields which just came into view
+	m_NewlyVisible.ForEach([&](uint16_t x, uint16_t y)
+	{
+		const Field& Field = m_Grid.Get(x, y);
+
+		Packet.push_back(x);
+		Packet.push_back(y);
+		Packet.push_back((uint8_t)Field.m_FieldType);
+		Packet.push_back((uint8_t)Field.m_OwnerID);
+		Packet.push_back((uint16_t)Field.m_Power);
+		Count++;
+	});
+
+	// Send changes of fields the player already knows
 	for (const FieldUpdate& Update : m_FieldUpdates)
 	{
-		FieldUpdates.push_back(
-			{
-				(uint16_t)Update.x,
-				(uint16_t)Update.y,
-				(uint8_t)Update.Field.m_FieldType,
-				(uint8_t)Update.Field.m_OwnerID,
-				(uint16_t)Update.Field.m_Power
-			}
-		);
+		if (!APlayer.m_Visible.Test(Update.x, Update.y))
+			continue;
+
+		// It may have left the view with this update, the client keeps showing it like this
+		APlayer.m_Shown.Assign(Update.x, Update.y, Update.Field.m_FieldType != Field::FieldType::FIELD_EMPTY);
+
+		Packet.push_back((uint16_t)Update.x);
+		Packet.push_back((uint16_t)Update.y);
+		Packet.push_back((uint8_t)Update.Field.m_FieldType);
+		Packet.push_back((uint8_t)Update.Field.m_OwnerID);
+		Packet.push_back((uint16_t)Update.Field.m_Power);
+		Count++;
 	}
 
-	Packet Packet(NetDataType::NET_GAME_DATA);
-	Packet.push_back(m_TurnPlayer.m_ID);
-	Packet.push_back(m_TurnTimeout);
-	Packet.push_back(FieldUpdates);
-	Packet.push_back(FoodUpdates);
+	Packet.EndStructs(CountIndex, Count);
 
-	m_pServer->GetSerializer()->SerializeSend(
-		Packet,
-		APlayer.m_Client.m_Socket
-	);
+	CountIndex = Packet.BeginStructs();
+	Count = 0;
+
+	for (const FieldUpdate& Update : m_FutureFieldUpdates)
+	{
+		if (Update.Field.m_FieldType != Field::FieldType::FIELD_FOOD)
+			continue;
+
+		if (!m_Visible.Test(Update.x, Update.y))
+			continue;
+
+		Packet.push_back((uint16_t)Update.x);
+		Packet.push_back((uint16_t)Update.y);
+		Count++;
+	}
+
+	Packet.EndStructs(CountIndex, Count);
+	Packet.push_back(m_Sessions.NextSequence(APlayer.m_ID));
+
+	if (m_Config.m_SendGridHash)
+		Packet.push_back(m_Grid.GetHash());
+
+	Send(Packet, APlayer.m_Socket);
+
+	// Kept even while disconnected, a reconnecting client gets exactly what it missed
+	m_Sessions.Record(APlayer.m_ID, Packet);
+
+	// Visible fields are now shown as they are, the rest as last seen
+	m_Occupied = m_Grid.GetOccupiedBits();
+	m_Occupied.And(m_Visible);
+	APlayer.m_Shown.AndNot(m_Visible);
+	APlayer.m_Shown.Or(m_Occupied);
+
+	// Keep the old board as scratch for the next player
+	std::swap(APlayer.m_Visible, m_Visible);
 }
 
-void GridGame::Kick(Client Client)
+void GridGame::Kick(const Client& Client)
 {
 	std::lock_guard LockGuard(m_Mutex);
 
 	// Check if this client is actually a player
-	PlayerIterator PlayerIt = GetPlayerByClient(Client);
-	if (PlayerIt == m_Players.end())
+	Player* pPlayer = GetPlayerByClient(Client);
+	if (!pPlayer)
+	{
+		m_Spectators.Remove(Client.m_Socket);
 		return;
+	}
+
+	if (m_Log.IsOpen())
+		m_Log.WriteKick(Client.m_Socket);
 
-	Player Player = PlayerIt->second;
+	// The connection gets closed, unlink its socket
+	pPlayer->m_HasLostConnection = true;
+	m_Players.SetSocket(pPlayer->m_ID, INVALID_SOCKET);
+
+	const Player& Player = *pPlayer;
 
 	// Create message
 	std::string Message = std::format("Player [{}] has left the game.", Player.m_Name);
@@ -432,17 +784,15 @@ void GridGame::Kick(Client Client)
 	// Broadcast
 	for (const auto& Player : m_Players)
 	{
-		m_pServer->GetSerializer()->SerializeSend(
-			Packet,
-			Player.second.m_Client.m_Socket
-		);
+		Send(Packet, Player.m_Socket);
 	}
 
-	std::cout << std::format("Player [{}] send an invalid packet and was disconnected.", Player.m_Name) << std::endl;
+	Logger::Write(LogLevel::LEVEL_WARNING, "Player [{}] send an invalid packet and was disconnected.", Player.m_Name);
 }
 
-void GridGame::Receive(Packet Data, Client Client)
+void GridGame::Receive(const Packet& Data, const Client& Client)
 {
+	AllocationScope Allocations(Allocations::GetPacketSite(Data.m_Magic));
 	std::lock_guard LockGuard(m_Mutex);
 
 	if (Data.m_Magic == NetDataType::NET_CONNECT)
@@ -451,36 +801,63 @@ void GridGame::Receive(Packet Data, Client Client)
 		return;
 	}
 
+	if (Data.m_Magic == NetDataType::NET_RECONNECT)
+	{
+		HandleReconnect(Data, Client);
+		return;
+	}
+
+	// Players already get their own stream
+	if (Data.m_Magic == NetDataType::NET_SPECTATE)
+	{
+		if (!GetPlayerByClient(Client) && m_pServer)
+			m_Spectators.Add(Client.m_Socket);
+
+		return;
+	}
+
 	// Check if this client is actually a player
-	auto PlayerIt = GetPlayerByClient(Client);
-	if (PlayerIt == m_Players.end())
+	Player* pPlayer = GetPlayerByClient(Client);
+	if (!pPlayer)
 		return;
 
 	switch (Data.m_Magic)
 	{
 	case NetDataType::NET_LEAVE:
-		HandleLeave(PlayerIt);
+		HandleLeave(pPlayer);
 		break;
 	case NetDataType::NET_MOVE:
-		HandleMove(Data, PlayerIt);
+		HandleMove(Data, pPlayer);
+		break;
+	case NetDataType::NET_MOVE_BATCH:
+		HandleMoveBatch(Data, pPlayer);
 		break;
 	case NetDataType::NET_END_TURN:
-		HandleEndTurn(PlayerIt);
+		HandleEndTurn(pPlayer);
 		break;
 	}
 }
 
-void GridGame::Disconnect(Client Client)
+void GridGame::Disconnect(const Client& Client)
 {
 	std::lock_guard LockGuard(m_Mutex);
 
 	// Check if this client is actually a player
-	auto PlayerIt = GetPlayerByClient(Client);
-	if (PlayerIt == m_Players.end())
+	Player* pPlayer = GetPlayerByClient(Client);
+	if (!pPlayer)
+	{
+		m_Spectators.Remove(Client.m_Socket);
 		return;
+	}
+
+	if (m_Log.IsOpen())
+		m_Log.WriteDisconnect(Client.m_Socket);
+
+	// Socket handles get reused, so unlink it until the player reconnects
+	pPlayer->m_HasLostConnection = true;
+	m_Players.SetSocket(pPlayer->m_ID, INVALID_SOCKET);
 
-	Player Player = PlayerIt->second;
-	m_Players[Player.m_ID].m_HasLostConnection = true;
+	const Player& Player = *pPlayer;
 
 	// Create message
 	std::string Message = std::format("Player [{}] lost connection.", Player.m_Name);
@@ -491,47 +868,48 @@ void GridGame::Disconnect(Client Client)
 	// Broadcast
 	for (const auto& Player : m_Players)
 	{
-		m_pServer->GetSerializer()->SerializeSend(
-			Packet,
-			Player.second.m_Client.m_Socket
-		);
+		Send(Packet, Player.m_Socket);
 	}
 
-	std::cout << Message << std::endl;;
+	Logger::Write(LogLevel::LEVEL_INFO, "Player [{}] lost connection.", Player.m_Name);
 }
 
-void GridGame::HandleLeave(PlayerIterator PlayerIt)
+void GridGame::HandleLeave(Player* pPlayer)
 {
-	Player Player = PlayerIt->second;
+	if (m_Log.IsOpen())
+		m_Log.WriteLeave(pPlayer->m_Socket);
+
+	// Only what outlives the removal, the player also holds its visibility planes
+	std::string Name = pPlayer->m_Name;
+	uint8_t PlayerID = pPlayer->m_ID;
 
 	// Create message
-	std::string Message = std::format("Player [{}] has left the game.", Player.m_Name);
+	std::string Message = std::format("Player [{}] has left the game.", Name);
 
 	Packet Packet(NetDataType::NET_BROADCAST);
 	Packet.push_back(Message);
 
 	// Remove player
-	m_Players.erase(PlayerIt);
+	m_Players.Remove(PlayerID);
+	m_Sessions.Close(PlayerID);
 
 	// Broadcast
 	for (const auto& Player : m_Players)
 	{
-		m_pServer->GetSerializer()->SerializeSend(
-			Packet,
-			Player.second.m_Client.m_Socket
-		);
+		Send(Packet, Player.m_Socket);
 	}
 
-	std::cout << Message << std::endl;;
+	Logger::Write(LogLevel::LEVEL_INFO, "Player [{}] has left the game.", Name);
 }
 
-void GridGame::HandleConnect(Packet PacketIn, Client Client)
+void GridGame::HandleConnect(const Packet& PacketIn, const Client& Client)
 {
-	Player APlayer;
-	PlayerIterator PlayerIt = GetPlayerByIP(Client.m_IP);
-	bool IsReconnect = (PlayerIt != m_Players.end()) && PlayerIt->second.m_HasLostConnection;
+	// Lost players come back through their session, a running game takes nobody new
+	if (m_GameRunning)
+		return;
 
-	if (!IsReconnect && m_GameRunning)
+	// Already joined with this connection or no free slot left
+	if (GetPlayerByClient(Client) || m_Players.IsFull())
 		return;
 
 	// Remove illegal chars from player name
@@ -541,71 +919,113 @@ void GridGame::HandleConnect(Packet PacketIn, Client Client)
 		[](auto const& Char) -> bool { return !std::isalnum(Char); }), PlayerName.end()
 	);
 
-	std::string Message;
+	const Player& APlayer = *m_Players.Add(Client.m_Socket, Client.m_IP, PlayerName);
+
+	// AI players never reconnect
+	uint64_t Token = Client.m_Socket < GRID_AI_SOCKET_BASE ? m_Sessions.Open(APlayer.m_ID) : 0;
+
+	std::string Message = std::format("Player [{}] has joined the game.", APlayer.m_Name);
+
+	// Send player ID and the token to reconnect with
+	Packet ConnectACK(NetDataType::NET_CONNECT_ACK);
+	ConnectACK.push_back(APlayer.m_ID);
+	ConnectACK.push_back(Token);
+
+	Send(ConnectACK, APlayer.m_Socket);
+
+	// Send connect message to all players
+	Packet Broadcast(NetDataType::NET_BROADCAST);
+	Broadcast.push_back(Message);
 
-	if (IsReconnect)
+	// Broadcast
+	for (const auto& Player : m_Players)
 	{
-		uint8_t PlayerID = PlayerIt->second.m_ID;
-		m_Players[PlayerID].m_HasLostConnection = false;
-		m_Players[PlayerID].m_Client.m_Socket = Client.m_Socket;
-		APlayer = m_Players[PlayerID];
+		if (Player == APlayer)
+			continue;
 
-		Message = std::format("Player [{}] has reconnected the game.", m_Players[PlayerID].m_Name);
+		Send(Broadcast, Player.m_Socket);
 	}
-	else
-	{
-		uint8_t LowestID = 0;
-		uint8_t Index = (uint8_t)std::distance(m_Players.begin(), m_Players.end());
 
-		for (uint8_t i = 0; i < Index + 1; i++)
-			if (m_Players.count(i) == 0)
-				LowestID = i;
+	Logger::Write(LogLevel::LEVEL_INFO, "{}", Message);
+}
 
-		APlayer = Player(LowestID, Client, PlayerName);
-		m_Players[LowestID] = APlayer;
+void GridGame::HandleReconnect(const Packet& Data, const Client& Client)
+{
+	uint8_t PlayerID = 0;
 
-		Message = std::format("Player [{}] has joined the game.", APlayer.m_Name);
-	}
+	// Unknown tokens get no answer, like a full lobby
+	if (GetPlayerByClient(Client) || !m_Sessions.Find(std::get<uint64_t>(Data.m_Data[0]), &PlayerID))
+		return;
+
+	if (Player* pPlayer = m_Players.Get(PlayerID))
+		ResumePlayer(pPlayer, Client, std::get<uint32_t>(Data.m_Data[1]));
+}
+
+void GridGame::ReconnectPlayer(uint8_t PlayerID, const Client& Client)
+{
+	std::lock_guard LockGuard(m_Mutex);
+
+	Player* pPlayer = m_Players.Get(PlayerID);
+
+	// Replays don't know what the client had, it gets a keyframe
+	if (pPlayer && !GetPlayerByClient(Client))
+		ResumePlayer(pPlayer, Client, 0);
+}
+
+void GridGame::ResumePlayer(Player* pPlayer, const Client& Client, uint32_t Sequence)
+{
+	if (m_Log.IsOpen())
+		m_Log.WriteReconnect(Client.m_Socket, pPlayer->m_ID);
+
+	// A half open connection may still hold the player, the new one takes over
+	pPlayer->m_HasLostConnection = false;
+	m_Players.SetSocket(pPlayer->m_ID, Client.m_Socket);
 
-	// Send player ID
 	Packet ConnectACK(NetDataType::NET_CONNECT_ACK);
-	ConnectACK.push_back(APlayer.m_ID);
+	ConnectACK.push_back(pPlayer->m_ID);
+	ConnectACK.push_back(m_Sessions.GetToken(pPlayer->m_ID));
 
-	m_pServer->GetSerializer()->SerializeSend(
-		ConnectACK,
-		APlayer.m_Client.m_Socket
-	);
+	Send(ConnectACK, Client.m_Socket);
+
+	std::string Message = std::format("Player [{}] has reconnected the game.", pPlayer->m_Name);
 
-	// Send connect message to all players
 	Packet Broadcast(NetDataType::NET_BROADCAST);
 	Broadcast.push_back(Message);
 
-	// Broadcast
 	for (const auto& Player : m_Players)
 	{
-		if (Player.second == APlayer)
+		if (Player == *pPlayer)
 			continue;
 
-		m_pServer->GetSerializer()->SerializeSend(
-			Broadcast,
-			Player.second.m_Client.m_Socket
-		);
+		Send(Broadcast, Player.m_Socket);
 	}
 
-	if (IsReconnect)
+	if (m_GameRunning)
 	{
-		SendPlayerData(APlayer);
-		SendClientUpdate(APlayer);
+		std::vector<const Packet*> Frames;
+
+		// Replay what was missed as it was sent, if it is gone start over from a keyframe
+		if (m_Sessions.GetFrames(pPlayer->m_ID, Sequence, &Frames))
+		{
+			for (const Packet* pFrame : Frames)
+				Send(*pFrame, Client.m_Socket);
+		}
+		else
+		{
+			SendPlayerData(*pPlayer);
+			pPlayer->m_Visible.Clear();
+			pPlayer->m_Shown.Resize(m_GridWidth, m_GridHeight);
+			pPlayer->m_Shown.Fill();
+			SendClientUpdate(*pPlayer);
+		}
 	}
 
-	std::cout << Message << std::endl;
+	Logger::Write(LogLevel::LEVEL_INFO, "{}", Message);
 }
 
-void GridGame::HandleMove(Packet Packet, PlayerIterator PlayerIt)
+void GridGame::HandleMove(const Packet& Packet, Player* pPlayer)
 {
-	// Ignore if this isnt the players turn
-	if (m_TurnPlayer != PlayerIt->second)
-		return;
+	TraceScope Scope("HandleMove");
 
 	bool ShouldSplit = std::get<bool>(Packet.m_Data[0]);
 	uint16_t FromX = std::get<uint16_t>(Packet.m_Data[1]);
@@ -613,147 +1033,667 @@ void GridGame::HandleMove(Packet Packet, PlayerIterator PlayerIt)
 	uint16_t ToX = std::get<uint16_t>(Packet.m_Data[3]);
 	uint16_t ToY = std::get<uint16_t>(Packet.m_Data[4]);
 
-	if (!IsValidMove(ShouldSplit, FromX, FromY, ToX, ToY, PlayerIt))
+	// Collect moves of all players until the window closes
+	if (m_Config.m_SimultaneousTurns)
+	{
+		QueueMove(ShouldSplit, FromX, FromY, ToX, ToY, pPlayer);
+		return;
+	}
+
+	// Ignore if this isnt the players turn
+	if (m_TurnPlayerID != pPlayer->m_ID)
+		return;
+
+	if (!IsValidMove(ShouldSplit, FromX, FromY, ToX, ToY, pPlayer))
 		return; // todo: notice player, kick, make lose?
 
-	Field* pOriginField = &m_Grid[FromX][FromY];
-	Field* pTargetField = &m_Grid[ToX][ToY];
+	if (m_Log.IsOpen())
+		m_Log.WriteMove(pPlayer->m_Socket, ShouldSplit, FromX, FromY, ToX, ToY);
+
+	ApplyMove(ShouldSplit, FromX, FromY, ToX, ToY);
+}
+
+void GridGame::HandleMoveBatch(const Packet& Data, Player* pPlayer)
+{
+	TraceScope Scope("HandleMoveBatch");
+
+	uint32_t MoveCount = std::get<uint32_t>(Data.m_Data[0]);
+	uint8_t PlayerID = pPlayer->m_ID;
+	bool IsTurnPlayer = m_Config.m_SimultaneousTurns || m_TurnPlayerID == pPlayer->m_ID;
+
+	std::vector<bool> Accepted(MoveCount, false);
+	std::vector<PacketStruct> Rejected;
 
-	std::unique_ptr<Field> pMover = std::make_unique<Field>();
+	// Fields changed by earlier moves of this batch, on top of the grid
+	std::unordered_map<uint32_t, Field> Snapshot;
 
-	if (ShouldSplit)
+	auto GetField = [&](uint16_t x, uint16_t y) -> Field
 	{
-		int16_t Power = pOriginField->m_Power;
+		auto It = Snapshot.find((uint32_t)y * m_GridWidth + x);
+		return It != Snapshot.end() ? It->second : m_Grid.Get(x, y);
+	};
 
-		pMover->m_FieldType = Field::FieldType::FIELD_WORKER;
-		pMover->m_OwnerID = pOriginField->m_OwnerID;
-		pMover->m_Power = (int)std::ceil(Power / 2.0);
-		pMover->m_WasMoved = true;
-		pOriginField->m_Power = (int)std::floor(Power / 2.0);
-		m_FieldUpdates.push_back(FieldUpdate(FromX, FromY, *pOriginField));
-	}
-	else 
+	// Validate all moves in one pass against the snapshot
+	for (uint32_t i = 0; i < MoveCount; i++)
 	{
-		pMover->m_FieldType = pOriginField->m_FieldType;
-		pMover->m_OwnerID = pOriginField->m_OwnerID;
-		pMover->m_Power = pOriginField->m_Power;
-		pMover->m_WasMoved = true;
+		std::size_t Offset = 1 + (std::size_t)i * 5;
+		bool ShouldSplit = std::get<bool>(Data.m_Data[Offset]);
+		uint16_t FromX = std::get<uint16_t>(Data.m_Data[Offset + 1]);
+		uint16_t FromY = std::get<uint16_t>(Data.m_Data[Offset + 2]);
+		uint16_t ToX = std::get<uint16_t>(Data.m_Data[Offset + 3]);
+		uint16_t ToY = std::get<uint16_t>(Data.m_Data[Offset + 4]);
+
+		MoveResult Result = MoveResult::MOVE_OK;
+
+		if (!IsTurnPlayer)
+			Result = MoveResult::MOVE_NOT_YOUR_TURN;
+		else if (i >= GRID_MAX_BATCH_MOVES)
+			Result = MoveResult::MOVE_BATCH_LIMIT;
+		else if (m_Config.m_SimultaneousTurns)
+			Result = QueueMove(ShouldSplit, FromX, FromY, ToX, ToY, pPlayer);
+		else
+			Result = Rules::CheckPath(FromX, FromY, ToX, ToY, m_GridWidth, m_GridHeight);
+
+		Field Origin, Target;
+
+		if (Result == MoveResult::MOVE_OK && !m_Config.m_SimultaneousTurns)
+		{
+			Origin = GetField(FromX, FromY);
+			Target = GetField(ToX, ToY);
+			Result = Rules::CheckWorker(ShouldSplit, Origin, PlayerID);
+		}
+
+		if (Result != MoveResult::MOVE_OK)
+		{
+			Rejected.push_back(
+				{
+					(uint16_t)std::min<uint32_t>(i, UINT16_MAX),
+					(uint8_t)Result,
+				}
+			);
+
+			continue;
+		}
 
-		// Reset the field we come from
-		pOriginField->Reset();
-		m_FieldUpdates.push_back(FieldUpdate(FromX, FromY, *pOriginField));
+		// Queued moves are resolved at the end of the window
+		if (m_Config.m_SimultaneousTurns)
+			continue;
+
+		Rules::ResolveMove(ShouldSplit, &Origin, &Target);
+		Snapshot[(uint32_t)FromY * m_GridWidth + FromX] = Origin;
+		Snapshot[(uint32_t)ToY * m_GridWidth + ToX] = Target;
+		Accepted[i] = true;
 	}
 
-	if (pTargetField->m_FieldType == Field::FieldType::FIELD_EMPTY)
+	// Apply accepted moves in order
+	for (uint32_t i = 0; i < MoveCount; i++)
 	{
-		// Move
-		*pTargetField = *pMover;
-		m_FieldUpdates.push_back(FieldUpdate(ToX, ToY, *pTargetField));
+		if (!Accepted[i])
+			continue;
 
-		return;
+		std::size_t Offset = 1 + (std::size_t)i * 5;
+		bool ShouldSplit = std::get<bool>(Data.m_Data[Offset]);
+		uint16_t FromX = std::get<uint16_t>(Data.m_Data[Offset + 1]);
+		uint16_t FromY = std::get<uint16_t>(Data.m_Data[Offset + 2]);
+		uint16_t ToX = std::get<uint16_t>(Data.m_Data[Offset + 3]);
+		uint16_t ToY = std::get<uint16_t>(Data.m_Data[Offset + 4]);
+
+		if (m_Log.IsOpen())
+			m_Log.WriteMove(pPlayer->m_Socket, ShouldSplit, FromX, FromY, ToX, ToY);
+
+		ApplyMove(ShouldSplit, FromX, FromY, ToX, ToY);
 	}
 
-	if (pTargetField->m_FieldType == Field::FieldType::FIELD_FOOD)
-	{
-		// Move & eat food
-		pTargetField->m_OwnerID = pMover->m_OwnerID;
-		pTargetField->m_Power = pMover->m_Power + pTargetField->m_Power;
-		pTargetField->m_FieldType = Field::FieldType::FIELD_WORKER;
-		pTargetField->m_WasMoved = true;
-		m_FieldUpdates.push_back(FieldUpdate(ToX, ToY, *pTargetField));
+	// Report rejected moves
+	Packet Result(NetDataType::NET_MOVE_BATCH_RESULT);
+	Result.push_back((uint16_t)std::min<std::size_t>(MoveCount - Rejected.size(), UINT16_MAX));
+	Result.push_back(Rejected);
+
+	Send(Result, pPlayer->m_Socket);
+}
+
+void GridGame::ApplyMove(bool Split, uint16_t FromX, uint16_t FromY, uint16_t ToX, uint16_t ToY)
+{
+	Field OriginField = m_Grid.Get(FromX, FromY);
+	Field TargetField = m_Grid.Get(ToX, ToY);
+
+	Rules::ResolveMove(Split, &OriginField, &TargetField);
+
+	m_Grid.Set(FromX, FromY, OriginField);
+	m_Grid.Set(ToX, ToY, TargetField);
+}
+
+MoveResult GridGame::QueueMove(bool Split, uint16_t FromX, uint16_t FromY, uint16_t ToX, uint16_t ToY, Player* pPlayer)
+{
+	if (pPlayer->m_HasEndedTurn)
+		return MoveResult::MOVE_NOT_YOUR_TURN;
+
+	MoveResult Result = Rules::CheckPath(FromX, FromY, ToX, ToY, m_GridWidth, m_GridHeight);
+
+	if (Result != MoveResult::MOVE_OK)
+		return Result;
+
+	Result = Rules::CheckWorker(Split, m_Grid, FromX, FromY, pPlayer->m_ID);
+
+	if (Result != MoveResult::MOVE_OK)
+		return Result;
 
+	// Every worker moves at most once per window
+	if (!m_PendingOrigins.insert((uint32_t)FromY * m_GridWidth + FromX).second)
+		return MoveResult::MOVE_ALREADY_MOVED;
+
+	if (m_Log.IsOpen())
+		m_Log.WriteMove(pPlayer->m_Socket, Split, FromX, FromY, ToX, ToY);
+
+	m_PendingMoves.push_back(
+		PendingMove(pPlayer->m_ID, Split, FromX, FromY, ToX, ToY, (uint32_t)m_PendingMoves.size())
+	);
+
+	return MoveResult::MOVE_OK;
+}
+
+void GridGame::ResolvePendingMoves()
+{
+	TraceScope Scope("ResolvePendingMoves");
+
+	if (m_PendingMoves.empty())
 		return;
+
+	// Split the grid into bands of chunk rows, one thread each
+	uint32_t RegionCount = 1;
+
+	if (m_PendingMoves.size() >= GRID_PARALLEL_MIN_MOVES)
+		RegionCount = std::clamp<uint32_t>(std::thread::hardware_concurrency(), 1, m_Grid.GetChunksY());
+
+	// The game thread takes the first band, the pool is only started once a turn is large enough
+	if (RegionCount > 1 && !m_pResolvePool)
+		m_pResolvePool = std::make_unique<ThreadPool>(std::thread::hardware_concurrency() - 1);
+
+	auto GetRegion = [&](uint16_t y) -> uint32_t
+	{
+		return (uint32_t)(y / GRID_CHUNK_SIZE) * RegionCount / m_Grid.GetChunksY();
+	};
+
+	auto ForEachRegion = [&](auto Function)
+	{
+		for (uint32_t Region = 1; Region < RegionCount; Region++)
+			m_pResolvePool->Submit([&Function, Region] { Function(Region); });
+
+		Function(0);
+
+		if (RegionCount > 1)
+			m_pResolvePool->Wait();
+	};
+
+	std::vector<std::vector<uint32_t>> OriginRegions(RegionCount);
+	std::vector<std::vector<uint32_t>> TargetRegions(RegionCount);
+	std::vector<std::vector<FieldUpdate>> Results(RegionCount);
+	std::vector<Field> Origins(m_PendingMoves.size());
+
+	for (uint32_t i = 0; i < m_PendingMoves.size(); i++)
+	{
+		OriginRegions[GetRegion(m_PendingMoves[i].FromY)].push_back(i);
+		TargetRegions[GetRegion(m_PendingMoves[i].ToY)].push_back(i);
 	}
 
-	if (pTargetField->m_FieldType == Field::FieldType::FIELD_WORKER)
+	// Lift all movers off their origin, origins are unique so regions never collide
+	ForEachRegion([&](uint32_t Region)
 	{
-		if (pTargetField->m_OwnerID == pMover->m_OwnerID)
+		for (uint32_t i : OriginRegions[Region])
 		{
-			// Move and merge
-			pMover->m_Power += pTargetField->m_Power;
-			*pTargetField = *pMover;
-			m_FieldUpdates.push_back(FieldUpdate(ToX, ToY, *pTargetField));
+			PendingMove& Move = m_PendingMoves[i];
 
-			return;
+			Origins[i] = m_Grid.Get(Move.FromX, Move.FromY);
+			Move.Mover = Rules::LiftMover(Move.Split, &Origins[i]);
 		}
+	});
+
+	for (uint32_t i = 0; i < m_PendingMoves.size(); i++)
+	{
+		m_Grid.Set(m_PendingMoves[i].FromX, m_PendingMoves[i].FromY, Origins[i]);
+	}
+
+	// Movers crossing a region border were handed to the region of their target above.
+	// Each region lands its movers per target field, ordered by a priority that rotates
+	// every turn and then by arrival, using the regular food/merge/fight rules
+	ForEachRegion([&](uint32_t Region)
+	{
+		std::vector<uint32_t>& Moves = TargetRegions[Region];
 
-		if (pMover->m_Power == pTargetField->m_Power)
+		auto GetKey = [&](uint32_t i)
 		{
-			// Kill eachother
-			pTargetField->Reset();
-			m_FieldUpdates.push_back(FieldUpdate(ToX, ToY, *pTargetField));
+			const PendingMove& Move = m_PendingMoves[i];
+			uint8_t Priority = (uint8_t)(Move.PlayerID - m_Turn);
 
-			return;
-		}
+			return std::make_tuple((uint32_t)Move.ToY * m_GridWidth + Move.ToX, Priority, Move.Order);
+		};
 
-		if (pMover->m_Power > pTargetField->m_Power)
+		std::sort(Moves.begin(), Moves.end(), [&](uint32_t A, uint32_t B) { return GetKey(A) < GetKey(B); });
+
+		for (std::size_t k = 0; k < Moves.size(); k++)
 		{
-			// Win fight and "gain" 1 power
-			pMover->m_Power = (pMover->m_Power - pTargetField->m_Power) + 1;
-			*pTargetField = *pMover;
-			m_FieldUpdates.push_back(FieldUpdate(ToX, ToY, *pTargetField));
+			const PendingMove& Move = m_PendingMoves[Moves[k]];
+
+			bool IsNewTarget = k == 0 ||
+				m_PendingMoves[Moves[k - 1]].ToX != Move.ToX ||
+				m_PendingMoves[Moves[k - 1]].ToY != Move.ToY;
 
-			return;
+			if (IsNewTarget)
+				Results[Region].push_back(FieldUpdate(Move.ToX, Move.ToY, m_Grid.Get(Move.ToX, Move.ToY)));
+
+			Rules::LandMover(Move.Mover, &Results[Region].back().Field);
 		}
+	});
+
+	for (const std::vector<FieldUpdate>& Updates : Results)
+	{
+		for (const FieldUpdate& Update : Updates)
+			m_Grid.Set(Update.x, Update.y, Update.Field);
+	}
 
-		if (pMover->m_Power < pTargetField->m_Power)
+	m_PendingMoves.clear();
+	m_PendingOrigins.clear();
+}
+
+bool GridGame::IsValidMove(bool Split, int FromX, int FromY, int ToX, int ToY, Player* pPlayer)
+{
+	if (Rules::CheckPath(FromX, FromY, ToX, ToY, m_GridWidth, m_GridHeight) != MoveResult::MOVE_OK)
+		return false;
+
+	return Rules::CheckWorker(Split, m_Grid, FromX, FromY, pPlayer->m_ID) == MoveResult::MOVE_OK;
+}
+
+Player* GridGame::GetPlayerByClient(const Client& Client)
+{
+	return m_Players.Find(Client.m_Socket);
+}
+
+void GridGame::RestorePlayer(uint8_t ID, SOCKET Socket, const std::string& IP, const std::string& Name, bool HasLostConnection)
+{
+	Player* pPlayer = m_Players.Add(ID, Socket, IP, Name);
+
+	if (!pPlayer)
+		return;
+
+	pPlayer->m_HasLostConnection = HasLostConnection;
+	pPlayer->m_IsAI = Socket >= GRID_AI_SOCKET_BASE && Socket != INVALID_SOCKET;
+
+	if (HasLostConnection)
+		m_Players.SetSocket(ID, INVALID_SOCKET);
+}
+
+bool GridGame::IsGameRunning() const
+{
+	return m_GameRunning;
+}
+
+uint32_t GridGame::GetTurn() const
+{
+	return m_Turn;
+}
+
+uint8_t GridGame::GetTurnPlayerID() const
+{
+	return m_TurnPlayerID;
+}
+
+const Grid& GridGame::GetGrid() const
+{
+	return m_Grid;
+}
+
+uint64_t GridGame::GetGridHash() const
+{
+	return m_Grid.GetHash();
+}
+
+void GridGame::SaveCheckpoint()
+{
+	std::string Path = std::format("{}/match.ckpt", m_Config.m_CheckpointDirectory);
+	std::string TempPath = Path + ".tmp";
+
+	std::size_t FieldCount = 0;
+
+	for (uint32_t ChunkIndex = 0; ChunkIndex < m_Grid.GetChunkCount(); ChunkIndex++)
+	{
+		const Chunk* pChunk = m_Grid.GetChunk(ChunkIndex);
+
+		if (!pChunk)
+			continue;
+
+		FieldCount += std::count_if(pChunk->m_Fields.begin(), pChunk->m_Fields.end(),
+			[](const Field& Field) { return Field.m_FieldType != Field::FieldType::FIELD_EMPTY; });
+	}
+
+	std::size_t Size = sizeof(CheckpointHeader) + m_Players.size() * sizeof(CheckpointPlayer) +
+		(FieldCount + m_FutureFieldUpdates.size()) * sizeof(CheckpointField);
+
+	MappedFile File;
+
+	if (!File.Create(TempPath, Size))
+	{
+		Logger::Write(LogLevel::LEVEL_ERROR, "Failed to write checkpoint [{}].", TempPath);
+		return;
+	}
+
+	CheckpointHeader* pHeader = (CheckpointHeader*)File.GetData();
+	pHeader->Magic = CHECKPOINT_MAGIC;
+	pHeader->Version = CHECKPOINT_VERSION;
+	pHeader->CheckpointID = ++m_CheckpointID;
+	pHeader->GridWidth = m_GridWidth;
+	pHeader->GridHeight = m_GridHeight;
+	pHeader->TurnSeconds = m_Config.m_TurnSeconds;
+	pHeader->SimultaneousTurns = m_Config.m_SimultaneousTurns;
+	pHeader->Turn = m_Turn;
+	pHeader->TurnPlayerID = m_TurnPlayerID;
+	pHeader->Seed = m_Random.GetSeed();
+	pHeader->PlayerCount = (uint32_t)m_Players.size();
+	pHeader->FieldCount = (uint32_t)FieldCount;
+	pHeader->FoodCount = (uint32_t)m_FutureFieldUpdates.size();
+	m_Random.GetState(pHeader->RandomState);
+	pHeader->GridHash = m_Grid.GetHash();
+
+	CheckpointPlayer* pPlayer = (CheckpointPlayer*)(pHeader + 1);
+
+	for (const Player& Player : m_Players)
+	{
+		*pPlayer = CheckpointPlayer();
+		pPlayer->ID = Player.m_ID;
+		pPlayer->HasLostGame = Player.m_HasLostGame;
+		Player.m_IP.copy(pPlayer->IP, CHECKPOINT_IP_LENGTH - 1);
+		Player.m_Name.copy(pPlayer->Name, CHECKPOINT_NAME_LENGTH - 1);
+		pPlayer->SessionToken = m_Sessions.GetToken(Player.m_ID);
+		pPlayer->Sequence = m_Sessions.GetSequence(Player.m_ID);
+		pPlayer++;
+	}
+
+	CheckpointField* pField = (CheckpointField*)pPlayer;
+
+	for (uint32_t ChunkIndex = 0; ChunkIndex < m_Grid.GetChunkCount(); ChunkIndex++)
+	{
+		const Chunk* pChunk = m_Grid.GetChunk(ChunkIndex);
+
+		if (!pChunk)
+			continue;
+
+		uint16_t ChunkX = (ChunkIndex % m_Grid.GetChunksX()) * GRID_CHUNK_SIZE;
+		uint16_t ChunkY = (ChunkIndex / m_Grid.GetChunksX()) * GRID_CHUNK_SIZE;
+
+		for (uint16_t i = 0; i < GRID_CHUNK_FIELDS; i++)
 		{
-			// Lose fight and enemy "gain" 1 power
-			pTargetField->m_Power = (pTargetField->m_Power - pMover->m_Power) + 1;
-			m_FieldUpdates.push_back(FieldUpdate(ToX, ToY, *pTargetField));
+			const Field& Field = pChunk->m_Fields[i];
+
+			if (Field.m_FieldType == Field::FieldType::FIELD_EMPTY)
+				continue;
 
-			return;
+			*pField++ = CheckpointField((uint16_t)(ChunkX + i % GRID_CHUNK_SIZE), (uint16_t)(ChunkY + i / GRID_CHUNK_SIZE),
+				(uint8_t)Field.m_FieldType, Field.m_OwnerID, Field.m_Power);
 		}
 	}
+
+	for (const FieldUpdate& Update : m_FutureFieldUpdates)
+	{
+		*pField++ = CheckpointField(Update.x, Update.y, (uint8_t)Update.Field.m_FieldType, Update.Field.m_OwnerID, Update.Field.m_Power);
+	}
+
+	File.Flush();
+	File.Close();
+
+	// Swap in the new checkpoint, then start a journal belonging to it
+	std::error_code Error;
+	std::filesystem::rename(TempPath, Path, Error);
+
+	if (Error)
+		return;
+
+	m_Log.OpenJournal(std::format("{}/match.journal", m_Config.m_CheckpointDirectory), m_CheckpointID);
 }
 
-bool GridGame::IsValidMove(bool Split, int FromX, int FromY, int ToX, int ToY, PlayerIterator PlayerIt)
+bool GridGame::RecoverCheckpoint()
 {
-	// Field is no worker
-	if (m_Grid[FromX][FromY].m_FieldType != Field::FieldType::FIELD_WORKER)
+	if (m_Config.m_CheckpointDirectory.empty())
 		return false;
 
-	// Worker not owned by player
-	if (m_Grid[FromX][FromY].m_OwnerID != PlayerIt->second.m_ID)
-		return false;
+	MappedFile File;
 
-	// Worker already moved this turn
-	if (m_Grid[FromX][FromY].m_WasMoved)
+	if (!File.Open(std::format("{}/match.ckpt", m_Config.m_CheckpointDirectory)) || File.GetSize() < sizeof(CheckpointHeader))
 		return false;
 
-	// Can split
-	if (Split && m_Grid[FromX][FromY].m_Power < 2)
+	auto Start = std::chrono::steady_clock::now();
+	const CheckpointHeader* pHeader = (const CheckpointHeader*)File.GetData();
+
+	if (pHeader->Magic != CHECKPOINT_MAGIC || pHeader->Version != CHECKPOINT_VERSION ||
+		File.GetSize() < sizeof(CheckpointHeader) + pHeader->PlayerCount * sizeof(CheckpointPlayer) +
+		((std::size_t)pHeader->FieldCount + pHeader->FoodCount) * sizeof(CheckpointField))
+	{
+		Logger::Write(LogLevel::LEVEL_WARNING, "Ignoring invalid checkpoint.");
 		return false;
+	}
 
-	// Out of bounds
-	if (ToX < 0 || ToX > m_Grid.size() - 1 || ToY < 0 || ToY > m_Grid.size() - 1)
+	// The turn order of the match can't change halfway through
+	if (pHeader->SimultaneousTurns != m_Config.m_SimultaneousTurns)
+	{
+		Logger::Write(LogLevel::LEVEL_WARNING, "Ignoring checkpoint of a match with other turn rules.");
 		return false;
+	}
+
+	// Only this match runs on the checkpoint's board and seed, the config stays for later ones
+	m_Grid = Grid(pHeader->GridWidth, pHeader->GridHeight);
+	m_GridWidth = m_Grid.GetWidth();
+	m_GridHeight = m_Grid.GetHeight();
+	m_Random.SetState(pHeader->Seed, pHeader->RandomState);
+	m_CheckpointID = pHeader->CheckpointID;
+	m_TurnPlayerID = pHeader->TurnPlayerID;
+	m_Turn = pHeader->Turn;
+
+	// Every player starts disconnected and comes back with the token of its session
+	const CheckpointPlayer* pPlayer = (const CheckpointPlayer*)(pHeader + 1);
+
+	m_Players.Clear();
+	m_Sessions.Clear();
+
+	for (uint32_t i = 0; i < pHeader->PlayerCount; i++, pPlayer++)
+	{
+		RestorePlayer(pPlayer->ID, INVALID_SOCKET,
+			std::string(pPlayer->IP, strnlen(pPlayer->IP, CHECKPOINT_IP_LENGTH)),
+			std::string(pPlayer->Name, strnlen(pPlayer->Name, CHECKPOINT_NAME_LENGTH)), true);
+
+		if (!m_Players.Contains(pPlayer->ID))
+			continue;
 
-	// Too far
-	if (std::abs(FromX - ToX) > 1 || std::abs(FromY - ToY) > 1)
+		m_Players[pPlayer->ID].m_HasLostGame = pPlayer->HasLostGame;
+		m_Sessions.Restore(pPlayer->ID, pPlayer->SessionToken, pPlayer->Sequence);
+	}
+
+	const CheckpointField* pField = (const CheckpointField*)pPlayer;
+
+	for (uint32_t i = 0; i < pHeader->FieldCount; i++, pField++)
+	{
+		if (m_Grid.IsInside(pField->x, pField->y))
+			m_Grid.Set(pField->x, pField->y, Field((Field::FieldType)pField->FieldType, pField->OwnerID, pField->Power));
+	}
+
+	// Torn or corrupted checkpoints don't rebuild the same grid
+	if (m_Grid.GetHash() != pHeader->GridHash)
+	{
+		Logger::Write(LogLevel::LEVEL_WARNING, "Checkpoint grid hash {:016x} does not match {:016x}, starting fresh.", m_Grid.GetHash(), pHeader->GridHash);
+		m_Grid.Clear();
+		m_Players.Clear();
+		m_Sessions.Clear();
 		return false;
+	}
+
+	m_FutureFieldUpdates.clear();
+
+	for (uint32_t i = 0; i < pHeader->FoodCount; i++, pField++)
+	{
+		m_FutureFieldUpdates.push_back(FieldUpdate(pField->x, pField->y, Field((Field::FieldType)pField->FieldType, pField->OwnerID, pField->Power)));
+	}
+
+	for (auto& Player : m_Players)
+	{
+		Player.m_WorkersAlive = m_Grid.GetWorkerCount(Player.m_ID);
+	}
+
+	// Players resync their view once they reconnect
+	m_Grid.CollectUpdates(&m_FieldUpdates);
+	m_FieldUpdates.clear();
+
+	m_NewGame = false;
+	m_GameRunning = true;
+	m_TurnEnded = false;
+	m_TurnTimeout = std::time(nullptr) + m_Config.m_TurnSeconds;
+	m_PendingMoves.clear();
+	m_PendingOrigins.clear();
+	m_History.clear();
+	m_History.push_back(TurnSnapshot(m_TurnPlayerID, m_Random, m_Grid.Snapshot(), m_FutureFieldUpdates, m_Grid.GetArena()));
+	m_FirstHistoryTurn = m_Turn;
+
+	File.Close();
+
+	// Re-apply the inputs since the checkpoint, saving a checkpoint meanwhile restarts the journal
+	std::ifstream JournalFile(std::format("{}/match.journal", m_Config.m_CheckpointDirectory), std::ios::binary);
+	std::stringstream Journal;
+	Journal << JournalFile.rdbuf();
+	JournalFile.close();
+
+	uint32_t JournalID = 0;
+	uint64_t Inputs = 0;
+	MatchLog::Record Type;
+
+	if (MatchLog::Read(Journal, &JournalID) && JournalID == m_CheckpointID)
+	{
+		while (MatchLog::Read(Journal, &Type) && Replay::ApplyRecord(this, Journal, Type))
+			Inputs++;
+	}
+
+	// Continue with a fresh checkpoint of the recovered state
+	SaveCheckpoint();
+
+	double Milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+	Logger::Write(LogLevel::LEVEL_INFO, "Recovered match at turn {} with {} journaled inputs in {:.2f}ms.", m_Turn, Inputs, Milliseconds);
 
 	return true;
 }
 
-PlayerIterator GridGame::GetPlayerByIP(std::string IP)
+void GridGame::RemoveCheckpoint()
 {
-	auto It = std::find_if(
-		m_Players.begin(),
-		m_Players.end(),
-		[IP](auto Player) { return Player.second.m_Client.m_IP == IP && Player.second.m_HasLostConnection == true; }
-	);
+	m_Log.CloseJournal();
 
-	return It;
+	std::error_code Error;
+	std::filesystem::remove(std::format("{}/match.ckpt", m_Config.m_CheckpointDirectory), Error);
+	std::filesystem::remove(std::format("{}/match.journal", m_Config.m_CheckpointDirectory), Error);
 }
 
-PlayerIterator GridGame::GetPlayerByClient(Client Client)
+void GridGame::UpdateAIPlayers(std::time_t Now)
 {
-	auto It = std::find_if(
-		m_Players.begin(), 
-		m_Players.end(), 
-		[Client](auto Player) { return Player.second.m_Client.m_Socket == Client.m_Socket; }
-	);
+	std::lock_guard LockGuard(m_Mutex);
+	std::vector<uint8_t> AIPlayers;
+	std::size_t Humans = 0;
+
+	for (const Player& Player : m_Players)
+	{
+		if (Player.m_IsAI)
+			AIPlayers.push_back(Player.m_ID);
+		else if (!Player.m_HasLostConnection)
+			Humans++;
+	}
+
+	// AI players only keep humans company
+	if (Humans == 0)
+	{
+		for (uint8_t PlayerID : AIPlayers)
+			HandleLeave(m_Players.Get(PlayerID));
+
+		m_LobbyStartTime = 0;
+		return;
+	}
+
+	if (!AIPlayers.empty() || Humans >= 2)
+	{
+		m_LobbyStartTime = 0;
+		return;
+	}
+
+	// Give other humans a chance to join first
+	if (m_LobbyStartTime == 0)
+		m_LobbyStartTime = Now;
+
+	if (Now - m_LobbyStartTime < m_Config.m_AIFillSeconds)
+		return;
+
+	// Join through the regular connect path so logs and replays see them like any player
+	for (uint32_t i = 0; i < m_Config.m_AIPlayers && !m_Players.IsFull(); i++)
+	{
+		Client AIClient(GRID_AI_SOCKET_BASE + i, std::format("ai-{}", i), nullptr);
+
+		Packet Data(NetDataType::NET_CONNECT);
+		Data.push_back(std::format("AI{}", i + 1));
 
-	return It;
+		HandleConnect(Data, AIClient);
+
+		if (Player* pPlayer = GetPlayerByClient(AIClient))
+			pPlayer->m_IsAI = true;
+	}
+
+	m_LobbyStartTime = 0;
+}
+
+void GridGame::PlayAITurns()
+{
+	std::vector<uint8_t> PlayerIDs;
+
+	{
+		std::lock_guard LockGuard(m_Mutex);
+
+		for (const Player& Player : m_Players)
+		{
+			if (!Player.m_IsAI || Player.m_HasEndedTurn)
+				continue;
+
+			if (m_Config.m_SimultaneousTurns ? !Player.m_HasLostGame : Player.m_ID == m_TurnPlayerID)
+				PlayerIDs.push_back(Player.m_ID);
+		}
+	}
+
+	if (PlayerIDs.empty())
+		return;
+
+	if (!m_pSearch)
+		m_pSearch = std::make_unique<MctsSearch>(m_Config.m_AIThreads ? m_Config.m_AIThreads : std::max(1u, std::thread::hardware_concurrency()));
+
+	// AI players acting this turn share the budget, which stays well below the turn timeout
+	double Budget = std::min<double>(m_Config.m_AIBudgetMs, m_Config.m_TurnSeconds * 1000.0 / 4) / 1000.0 / PlayerIDs.size();
+	std::vector<MctsMove> Moves;
+
+	for (uint8_t PlayerID : PlayerIDs)
+	{
+		// The search works on its own copy, so clients are only blocked while it is taken
+		{
+			std::lock_guard LockGuard(m_Mutex);
+			m_pSearch->Prepare(m_Grid, PlayerID);
+		}
+
+		m_pSearch->Search(Budget, Random::GenerateSeed(), &Moves);
+
+		std::lock_guard LockGuard(m_Mutex);
+		Player* pPlayer = m_Players.Get(PlayerID);
+
+		if (!pPlayer || !m_GameRunning)
+			continue;
+
+		for (const MctsMove& Move : Moves)
+		{
+			Packet Data(NetDataType::NET_MOVE);
+			Data.push_back(Move.Split);
+			Data.push_back(Move.FromX);
+			Data.push_back(Move.FromY);
+			Data.push_back(Move.ToX);
+			Data.push_back(Move.ToY);
+
+			HandleMove(Data, pPlayer);
+		}
+
+		HandleEndTurn(pPlayer);
+	}
 }
\ No newline at end of file
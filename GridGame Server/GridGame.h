@@ -2,38 +2,106 @@
 #include <mutex>
 #include <ctime>
 #include <queue>
+#include <memory>
 #include <vector>
+#include <unordered_set>
+#include "Grid.h"
+#include "Rules.h"
+#include "Random.h"
+#include "MatchLog.h"
 #include "Field.h"
 #include "Server.h"
+#include "NetworkSink.h"
 #include "Player.h"
+#include "PlayerTable.h"
 #include "Packet.h"
 #include "Serializer.h"
+#include "GameConfig.h"
+#include "Checkpoint.h"
+#include "MctsSearch.h"
+#include "ThreadPool.h"
+#include "SpectatorHub.h"
+#include "SessionTable.h"
 
-typedef std::map<uint8_t, Player>::iterator PlayerIterator;
+#define GRID_PARALLEL_MIN_MOVES 1024
+#define GRID_TURN_ARENA_SIZE (1 << 20)
+
+// AI players get sockets right below INVALID_SOCKET, packets to them are dropped
+#define GRID_AI_SOCKET_BASE (INVALID_SOCKET - MAX_PLAYERS - 1)
+
+struct PendingMove
+{
+	uint8_t PlayerID;
+	bool Split;
+	uint16_t FromX;
+	uint16_t FromY;
+	uint16_t ToX;
+	uint16_t ToY;
+	uint32_t Order;
+	Field Mover;
+};
+
+// State needed to resume a match at the start of a turn, the food list lives in the arena of its grid
+struct TurnSnapshot
+{
+	TurnSnapshot(uint8_t TurnPlayerID, const ::Random& Random, GridSnapshot Grid, const std::vector<FieldUpdate>& FutureFieldUpdates, std::pmr::memory_resource* pArena);
+	TurnSnapshot(TurnSnapshot&&) = default;
+	TurnSnapshot& operator=(const TurnSnapshot&) = delete;
+
+	uint8_t TurnPlayerID;
+	Random Random;
+	GridSnapshot Grid;
+	std::pmr::vector<FieldUpdate> FutureFieldUpdates;
+};
 
 class GridGame
 {
 public:
-	GridGame(Server* pServer);
+	GridGame(Server* pServer, GameConfig Config = GameConfig());
 	void Routine();
-	void Receive(Packet Data, Client Client);
-	void HandleConnect(Packet Data, Client Client);
-	void Disconnect(Client Client);
-	void Kick(Client Client);
-	void HandleLeave(PlayerIterator PlayerIt);
-	void HandleMove(Packet Data, PlayerIterator PlayerIt);
-	void HandleEndTurn(PlayerIterator PlayerIt);
+	void BeginMatch();
+	void AdvanceTurn(bool TimedOut);
+	void RestorePlayer(uint8_t ID, SOCKET Socket, const std::string& IP, const std::string& Name, bool HasLostConnection);
+	void Send(const Packet& Packet, SOCKET Socket);
+	void SetNetworkSink(NetworkSink* pSink);
+	void Receive(const Packet& Data, const Client& Client);
+	void HandleConnect(const Packet& Data, const Client& Client);
+	void HandleReconnect(const Packet& Data, const Client& Client);
+	void ReconnectPlayer(uint8_t PlayerID, const Client& Client);
+	void ResumePlayer(Player* pPlayer, const Client& Client, uint32_t Sequence);
+	void Disconnect(const Client& Client);
+	void Kick(const Client& Client);
+	void HandleLeave(Player* pPlayer);
+	void HandleMove(const Packet& Data, Player* pPlayer);
+	void HandleMoveBatch(const Packet& Data, Player* pPlayer);
+	void ApplyMove(bool Split, uint16_t FromX, uint16_t FromY, uint16_t ToX, uint16_t ToY);
+	void HandleEndTurn(Player* pPlayer);
+	void FinishTurn();
+	void ResolvePendingMoves();
 	void Tick();
 	void StartGame();
 	void PregenerateFood();
-	void SendPlayerData(Player Player);
-	void SendClientUpdate(Player Player);
+	void SendPlayerData(const Player& Player);
+	void SendClientUpdate(Player& Player);
 	void StartNewTurn();
+	void PublishSpectatorTurn(bool Keyframe);
+	bool RollbackToTurn(uint32_t Turn);
+	bool GetTurnSnapshot(uint32_t Turn, GridSnapshot* pSnapshot);
+	bool RecoverCheckpoint();
+	void SaveCheckpoint();
+	void RemoveCheckpoint();
+	void UpdateAIPlayers(std::time_t Now);
+	void PlayAITurns();
 
 	bool CheckWinConditions();
-	bool IsValidMove(bool Split, int FromX, int FromY, int ToX, int ToY, PlayerIterator PlayerIt);
-	PlayerIterator GetPlayerByIP(std::string IP);
-	PlayerIterator GetPlayerByClient(Client Client);
+	bool IsGameRunning() const;
+	uint32_t GetTurn() const;
+	uint8_t GetTurnPlayerID() const;
+	const Grid& GetGrid() const;
+	uint64_t GetGridHash() const;
+	MoveResult QueueMove(bool Split, uint16_t FromX, uint16_t FromY, uint16_t ToX, uint16_t ToY, Player* pPlayer);
+	bool IsValidMove(bool Split, int FromX, int FromY, int ToX, int ToY, Player* pPlayer);
+	Player* GetPlayerByClient(const Client& Client);
 
 private:
 	bool m_NewGame;
@@ -41,15 +109,36 @@ private:
 	bool m_GameRunning;
 	uint16_t m_GridWidth;
 	uint16_t m_GridHeight;
+	uint32_t m_Turn;
+	uint32_t m_FirstHistoryTurn;
+	uint32_t m_CheckpointID;
+	GameConfig m_Config;
+	Random m_Random;
+	MatchLog m_Log;
 	Server* m_pServer;
-	Player m_TurnPlayer;
+	NetworkSink* m_pSink;
+	uint8_t m_TurnPlayerID;
 	std::time_t m_QueueStartTime;
+	std::time_t m_LobbyStartTime;
 	std::time_t m_TurnTimeout;
+	uint64_t m_TraceTurnStart;
 	std::mutex m_Mutex;
-	std::map<uint8_t, Player> m_Players;
+	PlayerTable m_Players;
+	SessionTable m_Sessions;
 	std::vector<FieldUpdate> m_FieldUpdates;
 	std::vector<FieldUpdate> m_FutureFieldUpdates;
-	std::vector<std::vector<Field>> m_Grid;
+	std::vector<PendingMove> m_PendingMoves;
+	std::unordered_set<uint32_t> m_PendingOrigins;
+	std::vector<TurnSnapshot> m_History;
+	Bitboard m_Visible;
+	Bitboard m_NewlyVisible;
+	Bitboard m_Occupied;
+	std::vector<std::byte> m_TurnBuffer;
+	std::pmr::monotonic_buffer_resource m_TurnArena;
+	Grid m_Grid;
+	std::unique_ptr<MctsSearch> m_pSearch;
+	std::unique_ptr<ThreadPool> m_pResolvePool;
+	SpectatorHub m_Spectators;
 };
 
 extern GridGame* g_pGridGame;
@@ -1,5 +1,6 @@
 #pragma once
 #include <map>
+#include <cstdint>
 #include <vector>
 #include <variant>
 #include <initializer_list>
@@ -25,15 +26,18 @@ enum class InstructionType : int
 class InstructionStructure
 {
 public:
-    InstructionStructure(std::initializer_list<InstructionType> Types)
+    InstructionStructure(std::initializer_list<InstructionType> Types, uint32_t MaxCount = UINT32_MAX)
     {
         for (InstructionType Type : Types)
         {
             m_Types.push_back(Type);
         }
+
+        m_MaxCount = MaxCount;
     }
 
     std::vector<InstructionType> m_Types;
+    uint32_t m_MaxCount;
 };
 
 typedef std::variant<InstructionType, InstructionStructure> InstructionVariant;
@@ -64,6 +68,7 @@ public:
 
                 // Save actual struct data definition
                 m_StructLookup[(int)std::distance(m_Types.begin(), m_Types.end()) - 1] = Structure.m_Types;
+                m_StructLimits[(int)std::distance(m_Types.begin(), m_Types.end()) - 1] = Structure.m_MaxCount;
 
                 break;
             }
@@ -72,4 +77,5 @@ public:
 
     std::vector<InstructionType> m_Types;
     std::map<int, std::vector<InstructionType>> m_StructLookup;
+    std::map<int, uint32_t> m_StructLimits;
 };
\ No newline at end of file
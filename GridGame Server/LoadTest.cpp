@@ -0,0 +1,312 @@
+#include <Ws2tcpip.h>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include "LoadTest.h"
+#include "Field.h"
+#include "GameNetInstructions.h"
+
+LoadTest::LoadTest(const LoadTestConfig& Config)
+    : m_Random(Random::GenerateSeed())
+{
+    m_Config = Config;
+    m_MovesSent = 0;
+    m_EndTurnsSent = 0;
+    m_GameDataReceived = 0;
+    m_BytesReceived = 0;
+    m_Joined = 0;
+
+    GetGameInstructions(&m_Instructions);
+}
+
+int LoadTest::Run()
+{
+    WSADATA WSA;
+
+    if (WSAStartup(MAKEWORD(2, 2), &WSA) != NO_ERROR)
+        return 1;
+
+    ADDRINFOA Info = { 0 };
+    Info.ai_family = AF_UNSPEC;
+    Info.ai_socktype = SOCK_STREAM;
+    Info.ai_protocol = IPPROTO_TCP;
+
+    PADDRINFOA InfoResult;
+
+    if (getaddrinfo(m_Config.m_Host.c_str(), m_Config.m_Port.c_str(), &Info, &InfoResult) != 0)
+    {
+        std::cout << std::format("Failed to resolve [{}]:{}.", m_Config.m_Host, m_Config.m_Port) << std::endl;
+        WSACleanup();
+        return 1;
+    }
+
+    m_Clients.resize(m_Config.m_Clients);
+
+    for (LoadClient& Client : m_Clients)
+        Open(&Client, InfoResult);
+
+    freeaddrinfo(InfoResult);
+
+    std::vector<WSAPOLLFD> Fds(m_Clients.size());
+    Clock::time_point Start = Clock::now();
+    Clock::time_point End = Start + std::chrono::seconds(m_Config.m_Seconds);
+    Clock::duration MoveInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(m_Config.m_MoveRate, 0.001)));
+    Clock::duration EndTurnInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(m_Config.m_EndTurnRate, 0.001)));
+
+    while (Clock::now() < End)
+    {
+        for (std::size_t i = 0; i < m_Clients.size(); i++)
+        {
+            Fds[i].fd = m_Clients[i].m_IsClosed ? INVALID_SOCKET : m_Clients[i].m_Socket;
+            Fds[i].events = m_Clients[i].m_IsConnected ? POLLRDNORM : POLLWRNORM;
+            Fds[i].revents = 0;
+        }
+
+        if (WSAPoll(Fds.data(), (ULONG)Fds.size(), 1) == SOCKET_ERROR)
+            break;
+
+        Clock::time_point Now = Clock::now();
+
+        for (std::size_t i = 0; i < m_Clients.size(); i++)
+        {
+            LoadClient& Client = m_Clients[i];
+
+            if (Client.m_IsClosed)
+                continue;
+
+            if (Fds[i].revents & (POLLERR | POLLHUP | POLLNVAL))
+            {
+                Close(&Client);
+                continue;
+            }
+
+            // Connection established, join the lobby and spread actions over time
+            if (!Client.m_IsConnected && (Fds[i].revents & POLLWRNORM))
+            {
+                Client.m_IsConnected = true;
+                Client.m_NextMove = Now + MoveInterval * m_Random.NextBounded(1000) / 1000;
+                Client.m_NextEndTurn = Now + EndTurnInterval * m_Random.NextBounded(1000) / 1000;
+
+                Packet Data(NetDataType::NET_CONNECT);
+                Data.push_back(std::format("Load{}", i));
+
+                Client.m_Serializer.SerializeSend(Data, Client.m_Socket);
+                continue;
+            }
+
+            if (Fds[i].revents & POLLRDNORM)
+                Receive(&Client);
+
+            if (!Client.m_IsConnected || Client.m_IsClosed)
+                continue;
+
+            if (Now >= Client.m_NextMove)
+            {
+                SendMove(&Client);
+                Client.m_NextMove += MoveInterval;
+            }
+
+            if (Now >= Client.m_NextEndTurn)
+            {
+                Client.m_Serializer.SerializeSend(Packet(NetDataType::NET_END_TURN), Client.m_Socket);
+                Client.m_NextEndTurn += EndTurnInterval;
+                m_EndTurnsSent++;
+            }
+        }
+    }
+
+    Report(std::chrono::duration<double>(Clock::now() - Start).count());
+
+    for (LoadClient& Client : m_Clients)
+        Close(&Client);
+
+    WSACleanup();
+
+    return 0;
+}
+
+bool LoadTest::Open(LoadClient* pClient, const addrinfo* pAddress)
+{
+    pClient->m_Serializer.SetInstructions(&m_Instructions);
+    pClient->m_Socket = socket(pAddress->ai_family, SOCK_STREAM, IPPROTO_TCP);
+
+    if (pClient->m_Socket == INVALID_SOCKET)
+    {
+        pClient->m_IsClosed = true;
+        return false;
+    }
+
+    unsigned long Arg = 1;
+    ioctlsocket(pClient->m_Socket, FIONBIO, &Arg);
+
+    // Non blocking connect completes once the socket becomes writable
+    if (connect(pClient->m_Socket, pAddress->ai_addr, (int)pAddress->ai_addrlen) == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK)
+    {
+        Close(pClient);
+        return false;
+    }
+
+    return true;
+}
+
+void LoadTest::Close(LoadClient* pClient)
+{
+    if (pClient->m_Socket != INVALID_SOCKET)
+        closesocket(pClient->m_Socket);
+
+    pClient->m_Socket = INVALID_SOCKET;
+    pClient->m_IsClosed = true;
+}
+
+void LoadTest::Receive(LoadClient* pClient)
+{
+    char TempBuffer[LOADTEST_BUFFER_SIZE];
+    int RecvBytes = recv(pClient->m_Socket, TempBuffer, LOADTEST_BUFFER_SIZE, 0);
+
+    if (RecvBytes < 0)
+        return;
+
+    // Server closed the connection
+    if (RecvBytes == 0)
+    {
+        Close(pClient);
+        return;
+    }
+
+    m_BytesReceived += RecvBytes;
+    pClient->m_ReceiveBuffer.Append(TempBuffer, RecvBytes);
+
+    Serializer::State State = Serializer::State::STATE_DEFAULT;
+
+    while (pClient->m_ReceiveBuffer.GetSize() > 0 && State != Serializer::State::STATE_INCOMPLETE)
+    {
+        Packet Packet;
+        State = pClient->m_Serializer.Deserialize(&pClient->m_ReceiveBuffer, &Packet);
+
+        if (State == Serializer::State::STATE_ERROR)
+        {
+            Close(pClient);
+            return;
+        }
+
+        if (State == Serializer::State::STATE_SUCCESS)
+            Handle(pClient, Packet);
+    }
+}
+
+void LoadTest::Handle(LoadClient* pClient, const Packet& Data)
+{
+    switch (Data.m_Magic)
+    {
+    case NetDataType::NET_CONNECT_ACK:
+        pClient->m_PlayerID = std::get<uint8_t>(Data.m_Data[0]);
+        m_Joined++;
+        break;
+    case NetDataType::NET_GAME_DATA:
+    {
+        m_GameDataReceived++;
+
+        if (pClient->m_HasPendingMove)
+        {
+            m_Latencies.push_back(std::chrono::duration<double>(Clock::now() - pClient->m_MoveSentAt).count());
+            pClient->m_HasPendingMove = false;
+        }
+
+        // Keep track of own workers to send plausible moves
+        uint32_t FieldCount = std::get<uint32_t>(Data.m_Data[2]);
+
+        for (uint32_t i = 0; i < FieldCount; i++)
+        {
+            std::size_t Offset = 3 + (std::size_t)i * 5;
+            uint32_t Position = (uint32_t)std::get<uint16_t>(Data.m_Data[Offset + 1]) << 16 | std::get<uint16_t>(Data.m_Data[Offset]);
+            bool IsOwnWorker = std::get<uint8_t>(Data.m_Data[Offset + 2]) == (uint8_t)Field::FieldType::FIELD_WORKER && std::get<uint8_t>(Data.m_Data[Offset + 3]) == pClient->m_PlayerID;
+
+            if (IsOwnWorker)
+                pClient->m_Workers.insert(Position);
+            else
+                pClient->m_Workers.erase(Position);
+        }
+
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void LoadTest::SendMove(LoadClient* pClient)
+{
+    uint16_t FromX = 0;
+    uint16_t FromY = 0;
+
+    if (!pClient->m_Workers.empty())
+    {
+        auto It = pClient->m_Workers.begin();
+        std::advance(It, m_Random.NextBounded((uint32_t)pClient->m_Workers.size()));
+
+        FromX = (uint16_t)(*It & 0xFFFF);
+        FromY = (uint16_t)(*It >> 16);
+    }
+
+    Packet Data(NetDataType::NET_MOVE);
+    Data.push_back(false);
+    Data.push_back(FromX);
+    Data.push_back(FromY);
+    Data.push_back((uint16_t)std::max(0, FromX + (int)m_Random.NextBounded(3) - 1));
+    Data.push_back((uint16_t)std::max(0, FromY + (int)m_Random.NextBounded(3) - 1));
+
+    pClient->m_Serializer.SerializeSend(Data, pClient->m_Socket);
+
+    if (!pClient->m_HasPendingMove)
+    {
+        pClient->m_MoveSentAt = Clock::now();
+        pClient->m_HasPendingMove = true;
+    }
+
+    m_MovesSent++;
+}
+
+void LoadTest::Report(double Seconds)
+{
+    std::sort(m_Latencies.begin(), m_Latencies.end());
+
+    auto Percentile = [this](double Fraction)
+    {
+        if (m_Latencies.empty())
+            return 0.0;
+
+        return m_Latencies[std::min(m_Latencies.size() - 1, (std::size_t)(Fraction * m_Latencies.size()))] * 1e6;
+    };
+
+    uint32_t Connected = 0;
+    uint32_t Closed = 0;
+
+    for (const LoadClient& Client : m_Clients)
+    {
+        Connected += Client.m_IsConnected;
+        Closed += Client.m_IsClosed;
+    }
+
+    std::cout << std::format("{} clients, {} connected, {} joined, {} closed by the server after {:.1f}s.",
+        m_Clients.size(), Connected, m_Joined, Closed, Seconds) << std::endl;
+    std::cout << std::format("Sent {} moves ({:.0f}/s) and {} end turns, received {} game data ({:.0f}/s, {:.0f} bytes/s).",
+        m_MovesSent, m_MovesSent / Seconds, m_EndTurnsSent, m_GameDataReceived, m_GameDataReceived / Seconds, m_BytesReceived / Seconds) << std::endl;
+    std::cout << std::format("Move to game data latency p50 {:.0f}us p99 {:.0f}us p999 {:.0f}us over {} samples.",
+        Percentile(0.5), Percentile(0.99), Percentile(0.999), m_Latencies.size()) << std::endl;
+
+    std::ofstream File(m_Config.m_OutputPath, std::ios::trunc);
+
+    if (!File.is_open())
+        return;
+
+    File << std::format(
+        "{{\"clients\":{},\"connected\":{},\"joined\":{},\"closed\":{},\"seconds\":{:.3f},"
+        "\"moves_sent\":{},\"end_turns_sent\":{},\"game_data_received\":{},\"bytes_received\":{},"
+        "\"moves_per_second\":{:.1f},\"game_data_per_second\":{:.1f},"
+        "\"latency_us\":{{\"samples\":{},\"p50\":{:.1f},\"p99\":{:.1f},\"p999\":{:.1f}}}}}\n",
+        m_Clients.size(), Connected, m_Joined, Closed, Seconds,
+        m_MovesSent, m_EndTurnsSent, m_GameDataReceived, m_BytesReceived,
+        m_MovesSent / Seconds, m_GameDataReceived / Seconds,
+        m_Latencies.size(), Percentile(0.5), Percentile(0.99), Percentile(0.999));
+}
\ No newline at end of file
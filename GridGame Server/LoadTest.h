@@ -0,0 +1,72 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+
+#include <winsock2.h>
+#include <map>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include "Packet.h"
+#include "Random.h"
+#include "Serializer.h"
+#include "Instruction.h"
+#include "DynamicBuffer.h"
+
+#define LOADTEST_BUFFER_SIZE 4096
+
+struct LoadTestConfig
+{
+    std::string m_Host = "::1";
+    std::string m_Port = "42694";
+    std::string m_OutputPath = "loadtest.json";
+    uint32_t m_Clients = 1000;
+    uint32_t m_Seconds = 30;
+    double m_MoveRate = 2.0;
+    double m_EndTurnRate = 0.5;
+};
+
+// Opens many client connections speaking the game protocol and measures move to game data latency
+class LoadTest
+{
+public:
+    LoadTest(const LoadTestConfig& Config);
+    int Run();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct LoadClient
+    {
+        SOCKET m_Socket = INVALID_SOCKET;
+        bool m_IsConnected = false;
+        bool m_IsClosed = false;
+        bool m_HasPendingMove = false;
+        uint8_t m_PlayerID = 255;
+        Clock::time_point m_NextMove;
+        Clock::time_point m_NextEndTurn;
+        Clock::time_point m_MoveSentAt;
+        Serializer m_Serializer;
+        DynamicBuffer m_ReceiveBuffer = DynamicBuffer(LOADTEST_BUFFER_SIZE);
+        std::unordered_set<uint32_t> m_Workers;
+    };
+
+    bool Open(LoadClient* pClient, const addrinfo* pAddress);
+    void Close(LoadClient* pClient);
+    void Receive(LoadClient* pClient);
+    void Handle(LoadClient* pClient, const Packet& Packet);
+    void SendMove(LoadClient* pClient);
+    void Report(double Seconds);
+
+    LoadTestConfig m_Config;
+    Random m_Random;
+    std::map<NetDataType, Instruction> m_Instructions;
+    std::vector<LoadClient> m_Clients;
+    std::vector<double> m_Latencies;
+    uint64_t m_MovesSent;
+    uint64_t m_EndTurnsSent;
+    uint64_t m_GameDataReceived;
+    uint64_t m_BytesReceived;
+    uint32_t m_Joined;
+};
\ No newline at end of file
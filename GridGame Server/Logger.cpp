@@ -0,0 +1,282 @@
+#include <mutex>
+#include <chrono>
+#include <format>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <condition_variable>
+#include "Logger.h"
+
+static const char* s_LevelNames[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+
+static std::atomic<uint8_t> s_Level = (uint8_t)LogLevel::LEVEL_INFO;
+
+static uint64_t GetTime()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static std::string FormatArgument(const LogRecord& Record, const LogArgument& Argument, const std::string& Field)
+{
+	switch (Argument.m_Type)
+	{
+	case LogArgumentType::TYPE_INT:
+	{
+		int64_t Value = (int64_t)Argument.m_Value;
+		return std::vformat(Field, std::make_format_args(Value));
+	}
+	case LogArgumentType::TYPE_UINT:
+	{
+		uint64_t Value = Argument.m_Value;
+		return std::vformat(Field, std::make_format_args(Value));
+	}
+	case LogArgumentType::TYPE_DOUBLE:
+	{
+		double Value;
+		std::memcpy(&Value, &Argument.m_Value, sizeof(Value));
+		return std::vformat(Field, std::make_format_args(Value));
+	}
+	default:
+	{
+		std::string_view Value(Record.m_Text.data() + Argument.m_TextOffset, Argument.m_TextLength);
+		return std::vformat(Field, std::make_format_args(Value));
+	}
+	}
+}
+
+// Replacement fields are filled one by one, so each argument keeps its own format spec
+static void FormatRecord(const LogRecord& Record, std::string* pLine)
+{
+	uint64_t Milliseconds = Record.m_Time / 1000000;
+	uint64_t Seconds = Milliseconds / 1000;
+
+	*pLine += std::format("[{:02}:{:02}:{:02}.{:03}] [{}] ", Seconds / 3600 % 24, Seconds / 60 % 60, Seconds % 60, Milliseconds % 1000, s_LevelNames[(uint8_t)Record.m_Level]);
+
+	uint8_t ArgumentIndex = 0;
+
+	for (const char* pChar = Record.m_pFormat; *pChar; pChar++)
+	{
+		if ((*pChar == '{' || *pChar == '}') && pChar[1] == *pChar)
+		{
+			*pLine += *pChar++;
+			continue;
+		}
+
+		const char* pEnd = *pChar == '{' ? std::strchr(pChar, '}') : nullptr;
+
+		if (!pEnd || ArgumentIndex >= Record.m_ArgumentCount)
+		{
+			*pLine += *pChar;
+			continue;
+		}
+
+		// Positional indices are not supported, only the spec is kept
+		const char* pSpec = std::find(pChar, pEnd, ':');
+		std::string Field = "{" + std::string(pSpec, pEnd) + "}";
+
+		*pLine += FormatArgument(Record, Record.m_Arguments[ArgumentIndex++], Field);
+		pChar = pEnd;
+	}
+
+	*pLine += '\n';
+}
+
+// Owns the rings and the writer thread, rings stay registered until exit
+class LogWriter
+{
+public:
+	LogWriter()
+	{
+		m_Shutdown = false;
+		m_Thread = std::thread(&LogWriter::Routine, this);
+	}
+
+	~LogWriter()
+	{
+		{
+			std::lock_guard LockGuard(m_Mutex);
+			m_Shutdown = true;
+		}
+
+		m_Wakeup.notify_one();
+		m_Thread.join();
+	}
+
+	LogRing* AddRing()
+	{
+		std::unique_ptr<LogRing> pRing = std::make_unique<LogRing>();
+		LogRing* pResult = pRing.get();
+
+		std::lock_guard LockGuard(m_Mutex);
+		m_Rings.push_back(std::move(pRing));
+
+		return pResult;
+	}
+
+private:
+	void Routine()
+	{
+		std::unique_lock Lock(m_Mutex);
+
+		while (true)
+		{
+			m_Wakeup.wait_for(Lock, std::chrono::milliseconds(LOG_FLUSH_MS));
+
+			// Records written before the shutdown still get out
+			bool Shutdown = m_Shutdown;
+			Collect();
+
+			// New threads can register while the batch is written
+			Lock.unlock();
+			Write();
+			Lock.lock();
+
+			if (Shutdown)
+				return;
+		}
+	}
+
+	void Collect()
+	{
+		m_Records.clear();
+		m_Notices.clear();
+
+		for (const std::unique_ptr<LogRing>& pRing : m_Rings)
+		{
+			uint64_t Tail = pRing->m_Tail.load(std::memory_order_relaxed);
+			uint64_t Head = pRing->m_Head.load(std::memory_order_acquire);
+
+			for (; Tail < Head; Tail++)
+				m_Records.push_back(pRing->m_Records[Tail % LOG_RING_SIZE]);
+
+			pRing->m_Tail.store(Tail, std::memory_order_release);
+
+			uint64_t Dropped = pRing->m_Dropped.load(std::memory_order_relaxed);
+			uint64_t Limited = pRing->m_Limited.load(std::memory_order_relaxed);
+
+			if (Dropped == pRing->m_ReportedDropped && Limited == pRing->m_ReportedLimited)
+				continue;
+
+			m_Notices += std::format("Logger dropped {} records on a full ring and {} over the rate limit.\n", Dropped - pRing->m_ReportedDropped, Limited - pRing->m_ReportedLimited);
+
+			pRing->m_ReportedDropped = Dropped;
+			pRing->m_ReportedLimited = Limited;
+		}
+	}
+
+	void Write()
+	{
+		// Threads are merged by time
+		std::stable_sort(m_Records.begin(), m_Records.end(), [](const LogRecord& A, const LogRecord& B) { return A.m_Time < B.m_Time; });
+
+		m_Batch.clear();
+
+		for (const LogRecord& Record : m_Records)
+			FormatRecord(Record, &m_Batch);
+
+		m_Batch += m_Notices;
+
+		if (m_Batch.empty())
+			return;
+
+		std::cout.write(m_Batch.data(), (std::streamsize)m_Batch.size());
+		std::cout.flush();
+	}
+
+	bool m_Shutdown;
+	std::mutex m_Mutex;
+	std::condition_variable m_Wakeup;
+	std::thread m_Thread;
+	std::vector<std::unique_ptr<LogRing>> m_Rings;
+	std::vector<LogRecord> m_Records;
+	std::string m_Notices;
+	std::string m_Batch;
+};
+
+static LogWriter& GetWriter()
+{
+	static LogWriter s_Writer;
+	return s_Writer;
+}
+
+void Logger::SetLevel(LogLevel Level)
+{
+	s_Level = (uint8_t)Level;
+}
+
+bool Logger::ParseLevel(const std::string& Name, LogLevel* pLevel)
+{
+	static const std::pair<const char*, LogLevel> Levels[] = {
+		{ "debug", LogLevel::LEVEL_DEBUG },
+		{ "info", LogLevel::LEVEL_INFO },
+		{ "warning", LogLevel::LEVEL_WARNING },
+		{ "error", LogLevel::LEVEL_ERROR },
+	};
+
+	for (const auto& [LevelName, Level] : Levels)
+	{
+		if (Name == LevelName)
+		{
+			*pLevel = Level;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+LogRing* Logger::GetRing()
+{
+	thread_local LogRing* t_pRing = nullptr;
+
+	if (!t_pRing)
+		t_pRing = GetWriter().AddRing();
+
+	return t_pRing;
+}
+
+LogRecord* Logger::Begin(LogLevel Level)
+{
+	if ((uint8_t)Level < s_Level.load(std::memory_order_relaxed))
+		return nullptr;
+
+	LogRing* pRing = GetRing();
+	uint64_t Now = GetTime();
+
+	// A storm of records only costs a counter
+	if (Now / 1000000000 != pRing->m_WindowStart)
+	{
+		pRing->m_WindowStart = Now / 1000000000;
+		pRing->m_WindowCount = 0;
+	}
+
+	if (++pRing->m_WindowCount > LOG_RATE_LIMIT)
+	{
+		pRing->m_Limited.store(pRing->m_Limited.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	uint64_t Head = pRing->m_Head.load(std::memory_order_relaxed);
+
+	if (Head - pRing->m_Tail.load(std::memory_order_acquire) >= LOG_RING_SIZE)
+	{
+		pRing->m_Dropped.store(pRing->m_Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	LogRecord* pRecord = &pRing->m_Records[Head % LOG_RING_SIZE];
+	pRecord->m_Time = Now;
+	pRecord->m_Level = Level;
+	pRecord->m_ArgumentCount = 0;
+	pRecord->m_TextSize = 0;
+
+	return pRecord;
+}
+
+void Logger::Commit()
+{
+	LogRing* pRing = GetRing();
+	pRing->m_Head.store(pRing->m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <concepts>
+#include <string_view>
+
+#define LOG_RING_SIZE 512
+#define LOG_MAX_ARGUMENTS 6
+#define LOG_TEXT_SIZE 160
+#define LOG_RATE_LIMIT 500
+#define LOG_FLUSH_MS 20
+
+enum class LogLevel : uint8_t
+{
+	LEVEL_DEBUG,
+	LEVEL_INFO,
+	LEVEL_WARNING,
+	LEVEL_ERROR,
+};
+
+enum class LogArgumentType : uint8_t
+{
+	TYPE_INT,
+	TYPE_UINT,
+	TYPE_DOUBLE,
+	TYPE_TEXT,
+};
+
+struct LogArgument
+{
+	LogArgumentType m_Type;
+	uint16_t m_TextOffset;
+	uint16_t m_TextLength;
+	uint64_t m_Value;
+};
+
+// Arguments are kept raw, formatting happens on the writer thread
+struct LogRecord
+{
+	uint64_t m_Time;
+	LogLevel m_Level;
+	uint8_t m_ArgumentCount;
+	uint16_t m_TextSize;
+	const char* m_pFormat;
+	std::array<LogArgument, LOG_MAX_ARGUMENTS> m_Arguments;
+	std::array<char, LOG_TEXT_SIZE> m_Text;
+};
+
+// Single producer ring of one thread, read by the writer thread
+struct LogRing
+{
+	std::array<LogRecord, LOG_RING_SIZE> m_Records;
+	std::atomic<uint64_t> m_Head;
+	std::atomic<uint64_t> m_Tail;
+	std::atomic<uint64_t> m_Dropped;
+	std::atomic<uint64_t> m_Limited;
+	uint64_t m_WindowStart;
+	uint32_t m_WindowCount;
+	uint64_t m_ReportedDropped;
+	uint64_t m_ReportedLimited;
+};
+
+// Asynchronous logger, producers never block or touch the console
+class Logger
+{
+public:
+	// Format must be a string literal, it is read after the call returns
+	template<typename... Args>
+	static void Write(LogLevel Level, const char* pFormat, const Args&... Arguments)
+	{
+		static_assert(sizeof...(Args) <= LOG_MAX_ARGUMENTS, "Too many log arguments");
+
+		LogRecord* pRecord = Begin(Level);
+		if (!pRecord)
+			return;
+
+		pRecord->m_pFormat = pFormat;
+		(Pack(pRecord, Arguments), ...);
+
+		Commit();
+	}
+
+	static void SetLevel(LogLevel Level);
+	static bool ParseLevel(const std::string& Name, LogLevel* pLevel);
+
+private:
+	template<typename T>
+	static void Pack(LogRecord* pRecord, const T& Value)
+	{
+		LogArgument& Argument = pRecord->m_Arguments[pRecord->m_ArgumentCount++];
+
+		if constexpr (std::same_as<T, bool>)
+		{
+			Argument.m_Type = LogArgumentType::TYPE_UINT;
+			Argument.m_Value = Value;
+		}
+		else if constexpr (std::signed_integral<T>)
+		{
+			Argument.m_Type = LogArgumentType::TYPE_INT;
+			Argument.m_Value = (uint64_t)(int64_t)Value;
+		}
+		else if constexpr (std::unsigned_integral<T>)
+		{
+			Argument.m_Type = LogArgumentType::TYPE_UINT;
+			Argument.m_Value = (uint64_t)Value;
+		}
+		else if constexpr (std::floating_point<T>)
+		{
+			double Double = (double)Value;
+			Argument.m_Type = LogArgumentType::TYPE_DOUBLE;
+			std::memcpy(&Argument.m_Value, &Double, sizeof(Double));
+		}
+		else
+		{
+			// Text is cut off once the record is full
+			std::string_view Text(Value);
+			std::size_t Length = Text.size();
+
+			if (Length > LOG_TEXT_SIZE - pRecord->m_TextSize)
+				Length = LOG_TEXT_SIZE - pRecord->m_TextSize;
+
+			Argument.m_Type = LogArgumentType::TYPE_TEXT;
+			Argument.m_TextOffset = pRecord->m_TextSize;
+			Argument.m_TextLength = (uint16_t)Length;
+			std::memcpy(pRecord->m_Text.data() + pRecord->m_TextSize, Text.data(), Length);
+			pRecord->m_TextSize += (uint16_t)Length;
+		}
+	}
+
+	static LogRecord* Begin(LogLevel Level);
+	static void Commit();
+	static LogRing* GetRing();
+};
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include <windows.h>
+#include "MappedFile.h"
+
+MappedFile::MappedFile()
+{
+	m_File = INVALID_HANDLE_VALUE;
+	m_Mapping = nullptr;
+	m_pData = nullptr;
+	m_Size = 0;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Create(const std::string& Path, std::size_t Size)
+{
+	Close();
+
+	m_File = CreateFileA(Path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (m_File == INVALID_HANDLE_VALUE)
+		return false;
+
+	// Mapping a file with a size grows it to that size
+	m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)Size >> 32), (DWORD)Size, nullptr);
+
+	if (m_Mapping)
+		m_pData = (uint8_t*)MapViewOfFile(m_Mapping, FILE_MAP_WRITE, 0, 0, Size);
+
+	if (!m_pData)
+	{
+		Close();
+		return false;
+	}
+
+	m_Size = Size;
+
+	return true;
+}
+
+bool MappedFile::Open(const std::string& Path)
+{
+	Close();
+
+	m_File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (m_File == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER Size;
+
+	if (!GetFileSizeEx(m_File, &Size) || Size.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (m_Mapping)
+		m_pData = (uint8_t*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (!m_pData)
+	{
+		Close();
+		return false;
+	}
+
+	m_Size = (std::size_t)Size.QuadPart;
+
+	return true;
+}
+
+void MappedFile::Flush()
+{
+	if (!m_pData)
+		return;
+
+	FlushViewOfFile(m_pData, m_Size);
+	FlushFileBuffers(m_File);
+}
+
+void MappedFile::Close()
+{
+	if (m_pData)
+		UnmapViewOfFile(m_pData);
+
+	if (m_Mapping)
+		CloseHandle(m_Mapping);
+
+	if (m_File != INVALID_HANDLE_VALUE)
+		CloseHandle(m_File);
+
+	m_File = INVALID_HANDLE_VALUE;
+	m_Mapping = nullptr;
+	m_pData = nullptr;
+	m_Size = 0;
+}
+
+uint8_t* MappedFile::GetData() const
+{
+	return m_pData;
+}
+
+std::size_t MappedFile::GetSize() const
+{
+	return m_Size;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// File mapped into memory, either created with a fixed size or opened read only
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Create(const std::string& Path, std::size_t Size);
+	bool Open(const std::string& Path);
+	void Flush();
+	void Close();
+
+	uint8_t* GetData() const;
+	std::size_t GetSize() const;
+
+private:
+	void* m_File;
+	void* m_Mapping;
+	uint8_t* m_pData;
+	std::size_t m_Size;
+};
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "MatchLog.h"
+
+MatchLog::MatchLog()
+{
+}
+
+bool MatchLog::Open(const std::string& Path)
+{
+	Close();
+	m_File.open(Path, std::ios::binary | std::ios::trunc);
+
+	return m_File.is_open();
+}
+
+bool MatchLog::OpenJournal(const std::string& Path, uint32_t CheckpointID)
+{
+	// The journal only holds inputs since the checkpoint with this ID
+	CloseJournal();
+	m_Journal.open(Path, std::ios::binary | std::ios::trunc);
+	m_Journal.write((const char*)&CheckpointID, sizeof(CheckpointID));
+	m_Journal.flush();
+
+	return m_Journal.is_open();
+}
+
+void MatchLog::Close()
+{
+	if (m_File.is_open())
+		m_File.close();
+
+	CloseJournal();
+}
+
+void MatchLog::CloseJournal()
+{
+	if (m_Journal.is_open())
+		m_Journal.close();
+}
+
+bool MatchLog::IsOpen() const
+{
+	return m_File.is_open() || m_Journal.is_open();
+}
+
+void MatchLog::WriteHeader(const GameConfig& Config, uint64_t Seed)
+{
+	Write(Record::RECORD_HEADER);
+	Write<uint32_t>(MATCH_LOG_MAGIC);
+	Write<uint16_t>(MATCH_LOG_VERSION);
+	Write(Config.m_GridWidth);
+	Write(Config.m_GridHeight);
+	Write(Config.m_SimultaneousTurns);
+	Write(Seed);
+}
+
+void MatchLog::WritePlayer(const Player& Player)
+{
+	Write(Record::RECORD_PLAYER);
+	Write(Player.m_ID);
+	Write<uint64_t>(Player.m_Socket);
+	Write(Player.m_HasLostConnection);
+	WriteString(Player.m_IP);
+	WriteString(Player.m_Name);
+}
+
+void MatchLog::WriteDisconnect(SOCKET Socket)
+{
+	Write(Record::RECORD_DISCONNECT);
+	Write<uint64_t>(Socket);
+}
+
+void MatchLog::WriteKick(SOCKET Socket)
+{
+	Write(Record::RECORD_KICK);
+	Write<uint64_t>(Socket);
+}
+
+void MatchLog::WriteLeave(SOCKET Socket)
+{
+	Write(Record::RECORD_LEAVE);
+	Write<uint64_t>(Socket);
+}
+
+void MatchLog::WriteMove(SOCKET Socket, bool Split, uint16_t FromX, uint16_t FromY, uint16_t ToX, uint16_t ToY)
+{
+	Write(Record::RECORD_MOVE);
+	Write<uint64_t>(Socket);
+	Write(Split);
+	Write(FromX);
+	Write(FromY);
+	Write(ToX);
+	Write(ToY);
+}
+
+void MatchLog::WriteEndTurn(SOCKET Socket)
+{
+	Write(Record::RECORD_END_TURN);
+	Write<uint64_t>(Socket);
+}
+
+void MatchLog::WriteTurn(bool TimedOut, uint64_t GridHash)
+{
+	Write(Record::RECORD_TURN);
+	Write(TimedOut);
+	Write(GridHash);
+
+	// Recovery resumes at the last turn which reached the disk
+	if (m_Journal.is_open())
+		m_Journal.flush();
+}
+
+void MatchLog::WriteEnd(uint32_t Turn, uint64_t GridHash)
+{
+	Write(Record::RECORD_END);
+	Write(Turn);
+	Write(GridHash);
+
+	if (m_File.is_open())
+		m_File.flush();
+}
+
+void MatchLog::WriteRollback(uint32_t Turn)
+{
+	Write(Record::RECORD_ROLLBACK);
+	Write(Turn);
+}
+
+void MatchLog::WriteReconnect(SOCKET Socket, uint8_t PlayerID)
+{
+	Write(Record::RECORD_RECONNECT);
+	Write<uint64_t>(Socket);
+	Write(PlayerID);
+}
+
+void MatchLog::WriteBytes(const void* pData, std::size_t Size)
+{
+	if (m_File.is_open())
+		m_File.write((const char*)pData, Size);
+
+	if (m_Journal.is_open())
+		m_Journal.write((const char*)pData, Size);
+}
+
+void MatchLog::WriteString(const std::string& Value)
+{
+	uint8_t Length = (uint8_t)std::min<std::size_t>(Value.length(), UINT8_MAX);
+
+	Write(Length);
+	WriteBytes(Value.data(), Length);
+}
+
+bool MatchLog::ReadString(std::istream& Stream, std::string* pValue)
+{
+	uint8_t Length = 0;
+
+	if (!Read(Stream, &Length))
+		return false;
+
+	pValue->resize(Length);
+
+	return (bool)Stream.read(pValue->data(), Length);
+}
\ No newline at end of file
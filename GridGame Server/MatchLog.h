@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <fstream>
+#include <winsock2.h>
+#include "Player.h"
+#include "GameConfig.h"
+
+#define MATCH_LOG_MAGIC 0x474C4747
+#define MATCH_LOG_VERSION 4
+
+// Append-only binary log of every input applied to a match
+class MatchLog
+{
+public:
+	enum class Record : uint8_t
+	{
+		RECORD_HEADER,
+		RECORD_PLAYER,
+		RECORD_DISCONNECT,
+		RECORD_KICK,
+		RECORD_LEAVE,
+		RECORD_MOVE,
+		RECORD_END_TURN,
+		RECORD_TURN,
+		RECORD_END,
+		RECORD_ROLLBACK,
+		RECORD_RECONNECT,
+	};
+
+	MatchLog();
+	bool Open(const std::string& Path);
+	bool OpenJournal(const std::string& Path, uint32_t CheckpointID);
+	void Close();
+	void CloseJournal();
+	void WriteHeader(const GameConfig& Config, uint64_t Seed);
+	void WritePlayer(const Player& Player);
+	void WriteDisconnect(SOCKET Socket);
+	void WriteKick(SOCKET Socket);
+	void WriteLeave(SOCKET Socket);
+	void WriteMove(SOCKET Socket, bool Split, uint16_t FromX, uint16_t FromY, uint16_t ToX, uint16_t ToY);
+	void WriteEndTurn(SOCKET Socket);
+	void WriteTurn(bool TimedOut, uint64_t GridHash);
+	void WriteEnd(uint32_t Turn, uint64_t GridHash);
+	void WriteRollback(uint32_t Turn);
+	void WriteReconnect(SOCKET Socket, uint8_t PlayerID);
+
+	bool IsOpen() const;
+
+	template <typename T>
+	static bool Read(std::istream& Stream, T* pValue)
+	{
+		return (bool)Stream.read((char*)pValue, sizeof(T));
+	}
+
+	static bool ReadString(std::istream& Stream, std::string* pValue);
+
+private:
+	template <typename T>
+	void Write(T Value)
+	{
+		WriteBytes(&Value, sizeof(T));
+	}
+
+	void WriteBytes(const void* pData, std::size_t Size);
+	void WriteString(const std::string& Value);
+
+	std::ofstream m_File;
+	std::ofstream m_Journal;
+};
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include <cmath>
+#include <tuple>
+#include <algorithm>
+#include "MctsSearch.h"
+#include "Rules.h"
+
+#undef max
+#undef min
+
+MctsNode::MctsNode()
+{
+	m_Visits = 0;
+	m_Value = 0;
+	m_Children.fill(MCTS_UNEXPANDED);
+}
+
+MctsSearch::MctsSearch(std::size_t Threads)
+	: m_Pool(Threads)
+{
+	m_PlayerID = FIELD_NO_OWNER;
+	m_Rollouts = 0;
+	m_Trees.resize(m_Pool.GetSize());
+}
+
+void MctsSearch::Prepare(const Grid& Grid, uint8_t PlayerID)
+{
+	std::vector<std::tuple<int16_t, uint16_t, uint16_t>> Workers;
+
+	m_PlayerID = PlayerID;
+	m_Workers.clear();
+
+	Rules::GetMovable(Grid, PlayerID, &m_Movable);
+	m_Movable.ForEach([&](uint16_t x, uint16_t y) { Workers.push_back({ Grid.Get(x, y).m_Power, x, y }); });
+
+	if (Workers.empty())
+		return;
+
+	// Strongest workers first, the plan only covers a few of them
+	std::sort(Workers.begin(), Workers.end(), [](const auto& A, const auto& B) { return std::get<0>(A) > std::get<0>(B); });
+
+	// Limit the search to a window around the strongest worker
+	uint16_t WindowWidth = std::min<uint16_t>(Grid.GetWidth(), SIM_MAX_SIZE);
+	uint16_t WindowHeight = std::min<uint16_t>(Grid.GetHeight(), SIM_MAX_SIZE);
+	int WindowX = std::clamp(std::get<1>(Workers[0]) - SIM_MAX_SIZE / 2, 0, Grid.GetWidth() - WindowWidth);
+	int WindowY = std::clamp(std::get<2>(Workers[0]) - SIM_MAX_SIZE / 2, 0, Grid.GetHeight() - WindowHeight);
+	int MinX = Grid.GetWidth(), MinY = Grid.GetHeight(), MaxX = 0, MaxY = 0;
+
+	for (auto [Power, x, y] : Workers)
+	{
+		if (x < WindowX || x >= WindowX + WindowWidth || y < WindowY || y >= WindowY + WindowHeight)
+			continue;
+
+		m_Workers.push_back({ x, y });
+		MinX = std::min<int>(MinX, x);
+		MinY = std::min<int>(MinY, y);
+		MaxX = std::max<int>(MaxX, x);
+		MaxY = std::max<int>(MaxY, y);
+
+		if (m_Workers.size() == MCTS_MAX_PLAN_WORKERS)
+			break;
+	}
+
+	// Shrink the window to the planned workers and their surroundings, playouts scan all of it
+	MinX = std::max(MinX - MCTS_WINDOW_MARGIN, WindowX);
+	MinY = std::max(MinY - MCTS_WINDOW_MARGIN, WindowY);
+	MaxX = std::min(MaxX + MCTS_WINDOW_MARGIN, WindowX + WindowWidth - 1);
+	MaxY = std::min(MaxY + MCTS_WINDOW_MARGIN, WindowY + WindowHeight - 1);
+
+	m_Root.Load(Grid, MinX, MinY, MaxX - MinX + 1, MaxY - MinY + 1);
+
+	for (auto& [x, y] : m_Workers)
+	{
+		x -= MinX;
+		y -= MinY;
+	}
+}
+
+void MctsSearch::Search(double BudgetSeconds, uint64_t Seed, std::vector<MctsMove>* pMoves)
+{
+	pMoves->clear();
+	m_Rollouts = 0;
+
+	if (m_Workers.empty())
+		return;
+
+	auto Deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(BudgetSeconds));
+
+	for (std::size_t i = 0; i < m_Trees.size(); i++)
+	{
+		Tree& Tree = m_Trees[i];
+		Tree.m_Nodes.clear();
+		Tree.m_Nodes.emplace_back();
+		Tree.m_Random.SetSeed(Seed + i);
+		Tree.m_Rollouts = 0;
+
+		m_Pool.Submit([this, &Tree, Deadline] { Grow(&Tree, Deadline); });
+	}
+
+	m_Pool.Wait();
+
+	// Merge the trees level by level, following the most visited action of all threads
+	std::vector<int32_t> Cursors(m_Trees.size(), 0);
+
+	for (uint32_t Depth = 0; Depth < m_Workers.size(); Depth++)
+	{
+		std::array<uint64_t, MCTS_ACTIONS> Visits = {};
+
+		for (std::size_t i = 0; i < m_Trees.size(); i++)
+		{
+			if (Cursors[i] < 0)
+				continue;
+
+			for (uint32_t Action = 0; Action < MCTS_ACTIONS; Action++)
+			{
+				int32_t Child = m_Trees[i].m_Nodes[Cursors[i]].m_Children[Action];
+
+				if (Child >= 0)
+					Visits[Action] += m_Trees[i].m_Nodes[Child].m_Visits;
+			}
+		}
+
+		uint32_t Best = (uint32_t)(std::max_element(Visits.begin(), Visits.end()) - Visits.begin());
+
+		if (Visits[Best] == 0)
+			break;
+
+		for (std::size_t i = 0; i < m_Trees.size(); i++)
+		{
+			if (Cursors[i] >= 0)
+				Cursors[i] = m_Trees[i].m_Nodes[Cursors[i]].m_Children[Best];
+		}
+
+		// Holding needs no move
+		if (Best == 0)
+			continue;
+
+		auto [x, y] = m_Workers[Depth];
+		int StepX, StepY;
+		SimState::GetDirection((Best - 1) % SIM_DIRECTIONS, &StepX, &StepY);
+
+		pMoves->push_back({ Best > SIM_DIRECTIONS,
+			(uint16_t)(m_Root.GetX() + x), (uint16_t)(m_Root.GetY() + y),
+			(uint16_t)(m_Root.GetX() + x + StepX), (uint16_t)(m_Root.GetY() + y + StepY) });
+	}
+
+	for (const Tree& Tree : m_Trees)
+		m_Rollouts += Tree.m_Rollouts;
+}
+
+uint64_t MctsSearch::GetRollouts() const
+{
+	return m_Rollouts;
+}
+
+std::size_t MctsSearch::GetThreadCount() const
+{
+	return m_Pool.GetSize();
+}
+
+void MctsSearch::Grow(Tree* pTree, std::chrono::steady_clock::time_point Deadline) const
+{
+	std::vector<MctsNode>& Nodes = pTree->m_Nodes;
+	std::array<int32_t, MCTS_MAX_PLAN_WORKERS + 1> Path;
+
+	while (std::chrono::steady_clock::now() < Deadline)
+	{
+		SimState& State = pTree->m_State;
+		int32_t NodeIndex = 0;
+		uint32_t PathLength = 0;
+
+		State = m_Root;
+		Path[PathLength++] = 0;
+
+		for (uint32_t Depth = 0; Depth < m_Workers.size(); Depth++)
+		{
+			// Try an untried action first, starting at a random one
+			uint32_t Offset = pTree->m_Random.NextBounded(MCTS_ACTIONS);
+			int32_t Action = -1;
+
+			for (uint32_t i = 0; i < MCTS_ACTIONS && Action < 0; i++)
+			{
+				uint32_t Candidate = (Offset + i) % MCTS_ACTIONS;
+
+				if (Nodes[NodeIndex].m_Children[Candidate] != MCTS_UNEXPANDED)
+					continue;
+
+				// Own moves are deterministic, an action illegal once stays illegal
+				if (!PlayAction(&State, Depth, Candidate))
+				{
+					Nodes[NodeIndex].m_Children[Candidate] = MCTS_ILLEGAL;
+					continue;
+				}
+
+				Action = Candidate;
+			}
+
+			if (Action >= 0)
+			{
+				// A full tree keeps playing out from its leaves without growing
+				if (Nodes.size() < MCTS_MAX_NODES)
+				{
+					Nodes[NodeIndex].m_Children[Action] = (int32_t)Nodes.size();
+					Path[PathLength++] = (int32_t)Nodes.size();
+					Nodes.emplace_back();
+				}
+
+				break;
+			}
+
+			// Fully expanded, descend by UCT
+			const MctsNode& Node = Nodes[NodeIndex];
+			double LogVisits = std::log((double)Node.m_Visits + 1);
+			double BestScore = -1;
+			uint32_t BestAction = 0;
+
+			for (uint32_t Candidate = 0; Candidate < MCTS_ACTIONS; Candidate++)
+			{
+				int32_t Child = Node.m_Children[Candidate];
+
+				if (Child < 0)
+					continue;
+
+				const MctsNode& ChildNode = Nodes[Child];
+				double Score = ChildNode.m_Value / ChildNode.m_Visits + MCTS_EXPLORATION * std::sqrt(LogVisits / ChildNode.m_Visits);
+
+				if (Score > BestScore)
+				{
+					BestScore = Score;
+					BestAction = Candidate;
+				}
+			}
+
+			PlayAction(&State, Depth, BestAction);
+			NodeIndex = Node.m_Children[BestAction];
+			Path[PathLength++] = NodeIndex;
+		}
+
+		// Play out the following turns of everyone at random
+		for (uint32_t Turn = 0; Turn < MCTS_ROLLOUT_TURNS; Turn++)
+			State.PlayRandomTurn(&pTree->m_Random);
+
+		float Value = (float)Evaluate(State);
+
+		for (uint32_t i = 0; i < PathLength; i++)
+		{
+			Nodes[Path[i]].m_Visits++;
+			Nodes[Path[i]].m_Value += Value;
+		}
+
+		pTree->m_Rollouts++;
+	}
+}
+
+bool MctsSearch::PlayAction(SimState* pState, uint32_t Depth, uint32_t Action) const
+{
+	// Action 0 holds, then one step per direction followed by one split per direction
+	if (Action == 0)
+		return true;
+
+	auto [x, y] = m_Workers[Depth];
+	int StepX, StepY;
+	SimState::GetDirection((Action - 1) % SIM_DIRECTIONS, &StepX, &StepY);
+
+	return pState->ApplyMove(Action > SIM_DIRECTIONS, x, y, x + StepX, y + StepY, m_PlayerID);
+}
+
+double MctsSearch::Evaluate(const SimState& State) const
+{
+	std::array<int32_t, GRID_MAX_OWNERS> Power;
+	State.GetPower(&Power);
+
+	if (Power[m_PlayerID] == 0)
+		return 0;
+
+	// Own power against the strongest opponent in the window, squashed into [0, 1]
+	int32_t Strongest = 0;
+
+	for (uint32_t OwnerID = 0; OwnerID < FIELD_NO_OWNER; OwnerID++)
+	{
+		if (OwnerID != m_PlayerID)
+			Strongest = std::max(Strongest, Power[OwnerID]);
+	}
+
+	double Score = Power[m_PlayerID] - Strongest;
+
+	return 0.5 + 0.5 * Score / (std::abs(Score) + MCTS_SCORE_SCALE);
+}
\ No newline at end of file
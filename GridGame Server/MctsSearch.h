@@ -0,0 +1,71 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <vector>
+#include "Grid.h"
+#include "Random.h"
+#include "Bitboard.h"
+#include "SimState.h"
+#include "ThreadPool.h"
+
+#define MCTS_ACTIONS (1 + SIM_DIRECTIONS * 2)
+#define MCTS_MAX_PLAN_WORKERS 6
+#define MCTS_WINDOW_MARGIN 8
+#define MCTS_ROLLOUT_TURNS 4
+#define MCTS_MAX_NODES 50000
+#define MCTS_EXPLORATION 1.4
+#define MCTS_SCORE_SCALE 20.0
+#define MCTS_UNEXPANDED -1
+#define MCTS_ILLEGAL -2
+
+struct MctsNode
+{
+	MctsNode();
+
+	uint32_t m_Visits;
+	float m_Value;
+	std::array<int32_t, MCTS_ACTIONS> m_Children;
+};
+
+struct MctsMove
+{
+	bool Split;
+	uint16_t FromX;
+	uint16_t FromY;
+	uint16_t ToX;
+	uint16_t ToY;
+};
+
+// Plans one turn of a player. Each tree level picks the action of one of its strongest workers
+// (hold, step or split in a direction), leaves are scored by random playouts of all players.
+// Every pool thread grows its own tree, the visit counts are merged to pick the plan
+class MctsSearch
+{
+public:
+	MctsSearch(std::size_t Threads);
+	void Prepare(const Grid& Grid, uint8_t PlayerID);
+	void Search(double BudgetSeconds, uint64_t Seed, std::vector<MctsMove>* pMoves);
+	uint64_t GetRollouts() const;
+	std::size_t GetThreadCount() const;
+
+private:
+	struct Tree
+	{
+		std::vector<MctsNode> m_Nodes;
+		Random m_Random;
+		SimState m_State;
+		uint64_t m_Rollouts = 0;
+	};
+
+	void Grow(Tree* pTree, std::chrono::steady_clock::time_point Deadline) const;
+	bool PlayAction(SimState* pState, uint32_t Depth, uint32_t Action) const;
+	double Evaluate(const SimState& State) const;
+
+	uint8_t m_PlayerID;
+	uint64_t m_Rollouts;
+	SimState m_Root;
+	Bitboard m_Movable;
+	std::vector<std::pair<uint16_t, uint16_t>> m_Workers;
+	std::vector<Tree> m_Trees;
+	ThreadPool m_Pool;
+};
\ No newline at end of file
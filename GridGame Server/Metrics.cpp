@@ -0,0 +1,214 @@
+#include <bit>
+#include <mutex>
+#include <chrono>
+#include <format>
+#include <memory>
+#include <vector>
+#include "Metrics.h"
+#include "Allocations.h"
+
+static const char* s_CounterNames[] = { "accepted_total", "rejected_total", "decode_errors_total", "outbound_coalesced_total", "outbound_degraded_total", "outbound_skipped_updates_total", "outbound_disconnects_total", "rate_limited_total", "rate_disconnects_total" };
+static const char* s_HistogramNames[] = { "decode_ns", "encode_ns", "tick_ns", "turn_ns" };
+static const char* s_GaugeNames[] = { "matches_active", "players_active", "spectators_active", "outbound_queue_depth", "client_queue_bytes", "degraded_clients" };
+
+static std::array<std::atomic<int64_t>, (std::size_t)MetricGauge::GAUGE_COUNT> s_Gauges;
+
+// Shards live until exit, a finished thread keeps its counts
+static std::mutex& GetShardMutex()
+{
+	static std::mutex s_Mutex;
+	return s_Mutex;
+}
+
+static std::vector<std::unique_ptr<MetricShard>>& GetShards()
+{
+	static std::vector<std::unique_ptr<MetricShard>> s_Shards;
+	return s_Shards;
+}
+
+static void Increment(std::atomic<uint64_t>& Value, uint64_t Amount)
+{
+	Value.store(Value.load(std::memory_order_relaxed) + Amount, std::memory_order_relaxed);
+}
+
+MetricShard* Metrics::GetShard()
+{
+	thread_local MetricShard* t_pShard = nullptr;
+
+	if (t_pShard)
+		return t_pShard;
+
+	std::unique_ptr<MetricShard> pShard = std::make_unique<MetricShard>();
+	t_pShard = pShard.get();
+
+	std::lock_guard LockGuard(GetShardMutex());
+	GetShards().push_back(std::move(pShard));
+
+	return t_pShard;
+}
+
+void Metrics::Add(MetricCounter Counter, uint64_t Value)
+{
+	Increment(GetShard()->m_Counters[(std::size_t)Counter], Value);
+}
+
+void Metrics::CountDecoded(NetDataType Type)
+{
+	if ((uint32_t)Type < METRICS_NET_TYPES)
+		Increment(GetShard()->m_Decoded[(uint32_t)Type], 1);
+}
+
+void Metrics::CountSent(NetDataType Type)
+{
+	if ((uint32_t)Type < METRICS_NET_TYPES)
+		Increment(GetShard()->m_Sent[(uint32_t)Type], 1);
+}
+
+void Metrics::Record(MetricHistogram Histogram, uint64_t Value)
+{
+	MetricShard* pShard = GetShard();
+
+	Increment(pShard->m_Buckets[(std::size_t)Histogram][GetBucket(Value)], 1);
+	Increment(pShard->m_Sums[(std::size_t)Histogram], Value);
+}
+
+void Metrics::Set(MetricGauge Gauge, int64_t Value)
+{
+	s_Gauges[(std::size_t)Gauge].store(Value, std::memory_order_relaxed);
+}
+
+uint64_t Metrics::GetTime()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t Metrics::GetBucket(uint64_t Value)
+{
+	// Small values are exact, above that 16 buckets per power of two
+	if (Value < METRICS_SUB_BUCKETS)
+		return (uint32_t)Value;
+
+	uint32_t Exponent = (uint32_t)std::bit_width(Value) - 1;
+	uint32_t Mantissa = (uint32_t)(Value >> (Exponent - 4)) & (METRICS_SUB_BUCKETS - 1);
+
+	return (Exponent - 3) * METRICS_SUB_BUCKETS + Mantissa;
+}
+
+uint64_t Metrics::GetBucketValue(uint32_t Bucket)
+{
+	if (Bucket < METRICS_SUB_BUCKETS)
+		return Bucket;
+
+	uint32_t Exponent = Bucket / METRICS_SUB_BUCKETS + 3;
+	uint64_t Mantissa = Bucket % METRICS_SUB_BUCKETS;
+
+	return (METRICS_SUB_BUCKETS + Mantissa) << (Exponent - 4);
+}
+
+std::string Metrics::Format()
+{
+	std::array<uint64_t, (std::size_t)MetricCounter::COUNTER_COUNT> Counters = {};
+	std::array<uint64_t, METRICS_NET_TYPES> Decoded = {};
+	std::array<uint64_t, METRICS_NET_TYPES> Sent = {};
+	std::array<uint64_t, (std::size_t)MetricHistogram::HISTOGRAM_COUNT> Sums = {};
+	std::vector<std::array<uint64_t, METRICS_BUCKETS>> Buckets((std::size_t)MetricHistogram::HISTOGRAM_COUNT);
+
+	{
+		std::lock_guard LockGuard(GetShardMutex());
+
+		for (const std::unique_ptr<MetricShard>& pShard : GetShards())
+		{
+			for (std::size_t i = 0; i < Counters.size(); i++)
+				Counters[i] += pShard->m_Counters[i].load(std::memory_order_relaxed);
+
+			for (std::size_t i = 0; i < METRICS_NET_TYPES; i++)
+			{
+				Decoded[i] += pShard->m_Decoded[i].load(std::memory_order_relaxed);
+				Sent[i] += pShard->m_Sent[i].load(std::memory_order_relaxed);
+			}
+
+			for (std::size_t h = 0; h < Sums.size(); h++)
+			{
+				Sums[h] += pShard->m_Sums[h].load(std::memory_order_relaxed);
+
+				for (std::size_t i = 0; i < METRICS_BUCKETS; i++)
+					Buckets[h][i] += pShard->m_Buckets[h][i].load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Prometheus text format, packet types by their NetDataType value
+	std::string Text;
+
+	for (std::size_t i = 0; i < Counters.size(); i++)
+		Text += std::format("gridgame_{} {}\n", s_CounterNames[i], Counters[i]);
+
+	for (std::size_t i = 0; i < METRICS_NET_TYPES; i++)
+	{
+		if (Decoded[i])
+			Text += std::format("gridgame_packets_decoded_total{{type=\"{}\"}} {}\n", i, Decoded[i]);
+
+		if (Sent[i])
+			Text += std::format("gridgame_packets_sent_total{{type=\"{}\"}} {}\n", i, Sent[i]);
+	}
+
+	for (std::size_t h = 0; h < Sums.size(); h++)
+	{
+		uint64_t Count = 0;
+		uint64_t Max = 0;
+
+		for (uint32_t i = 0; i < METRICS_BUCKETS; i++)
+		{
+			Count += Buckets[h][i];
+
+			if (Buckets[h][i])
+				Max = GetBucketValue(i);
+		}
+
+		for (double Quantile : { 0.5, 0.9, 0.99, 0.999 })
+		{
+			uint64_t Rank = (uint64_t)(Quantile * Count);
+			uint64_t Seen = 0;
+			uint64_t Value = 0;
+
+			for (uint32_t i = 0; i < METRICS_BUCKETS && Count; i++)
+			{
+				Seen += Buckets[h][i];
+				Value = GetBucketValue(i);
+
+				if (Seen > Rank)
+					break;
+			}
+
+			Text += std::format("gridgame_{}{{quantile=\"{}\"}} {}\n", s_HistogramNames[h], Quantile, Value);
+		}
+
+		Text += std::format("gridgame_{}_max {}\n", s_HistogramNames[h], Max);
+		Text += std::format("gridgame_{}_sum {}\n", s_HistogramNames[h], Sums[h]);
+		Text += std::format("gridgame_{}_count {}\n", s_HistogramNames[h], Count);
+	}
+
+	for (std::size_t i = 0; i < s_Gauges.size(); i++)
+		Text += std::format("gridgame_{} {}\n", s_GaugeNames[i], s_Gauges[i].load(std::memory_order_relaxed));
+
+	if (!Allocations::IsTracking())
+		return Text;
+
+	// Only in builds with GRIDGAME_ALLOC_TRACKING
+	for (uint32_t i = 0; i < (uint32_t)AllocationSite::SITE_COUNT; i++)
+	{
+		AllocationSite Site = (AllocationSite)i;
+
+		if (!Allocations::GetCount(Site))
+			continue;
+
+		std::string Labels = Site >= AllocationSite::SITE_PACKET
+			? std::format("site=\"packet\",type=\"{}\"", i - (uint32_t)AllocationSite::SITE_PACKET)
+			: std::format("site=\"{}\"", Allocations::GetSiteName(Site));
+
+		Text += std::format("gridgame_allocations_total{{{}}} {}\n", Labels, Allocations::GetCount(Site));
+		Text += std::format("gridgame_allocated_bytes_total{{{}}} {}\n", Labels, Allocations::GetBytes(Site));
+	}
+
+	return Text;
+}
\ No newline at end of file
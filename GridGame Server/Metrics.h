@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include "Packet.h"
+
+#define METRICS_NET_TYPES 32
+#define METRICS_SUB_BUCKETS 16
+#define METRICS_BUCKETS 1024
+
+enum class MetricCounter : uint32_t
+{
+	COUNTER_ACCEPTED,
+	COUNTER_REJECTED,
+	COUNTER_DECODE_ERRORS,
+	COUNTER_OUTBOUND_COALESCED,
+	COUNTER_OUTBOUND_DEGRADED,
+	COUNTER_OUTBOUND_SKIPPED,
+	COUNTER_OUTBOUND_DISCONNECTS,
+	COUNTER_RATE_LIMITED,
+	COUNTER_RATE_DISCONNECTS,
+	COUNTER_COUNT
+};
+
+enum class MetricHistogram : uint32_t
+{
+	HISTOGRAM_DECODE_NS,
+	HISTOGRAM_ENCODE_NS,
+	HISTOGRAM_TICK_NS,
+	HISTOGRAM_TURN_NS,
+	HISTOGRAM_COUNT
+};
+
+enum class MetricGauge : uint32_t
+{
+	GAUGE_MATCHES,
+	GAUGE_PLAYERS,
+	GAUGE_SPECTATORS,
+	GAUGE_OUTBOUND_QUEUE,
+	GAUGE_CLIENT_QUEUE_BYTES,
+	GAUGE_DEGRADED_CLIENTS,
+	GAUGE_COUNT
+};
+
+// Written by one thread only, so updates are plain relaxed stores
+struct MetricShard
+{
+	std::array<std::atomic<uint64_t>, (std::size_t)MetricCounter::COUNTER_COUNT> m_Counters;
+	std::array<std::atomic<uint64_t>, METRICS_NET_TYPES> m_Decoded;
+	std::array<std::atomic<uint64_t>, METRICS_NET_TYPES> m_Sent;
+	std::array<std::array<std::atomic<uint64_t>, METRICS_BUCKETS>, (std::size_t)MetricHistogram::HISTOGRAM_COUNT> m_Buckets;
+	std::array<std::atomic<uint64_t>, (std::size_t)MetricHistogram::HISTOGRAM_COUNT> m_Sums;
+};
+
+// Process wide counters, log-linear histograms and gauges, summed over the thread shards when read
+class Metrics
+{
+public:
+	static void Add(MetricCounter Counter, uint64_t Value = 1);
+	static void CountDecoded(NetDataType Type);
+	static void CountSent(NetDataType Type);
+	static void Record(MetricHistogram Histogram, uint64_t Value);
+	static void Set(MetricGauge Gauge, int64_t Value);
+	static uint64_t GetTime();
+	static uint32_t GetBucket(uint64_t Value);
+	static uint64_t GetBucketValue(uint32_t Bucket);
+	static std::string Format();
+
+private:
+	static MetricShard* GetShard();
+};
\ No newline at end of file
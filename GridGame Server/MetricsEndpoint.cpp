@@ -0,0 +1,110 @@
+#include <Ws2tcpip.h>
+#include <format>
+#include <string_view>
+#include "MetricsEndpoint.h"
+#include "Metrics.h"
+#include "Logger.h"
+#include "Trace.h"
+
+MetricsEndpoint::MetricsEndpoint()
+{
+    m_Socket = INVALID_SOCKET;
+}
+
+MetricsEndpoint::~MetricsEndpoint()
+{
+    // Closing the listener ends the blocking accept
+    if (m_Socket != INVALID_SOCKET)
+        closesocket(m_Socket);
+
+    if (m_Thread.joinable())
+        m_Thread.join();
+}
+
+bool MetricsEndpoint::Start(const std::string& Port, const std::string& Address)
+{
+    WSADATA WSA;
+
+    if (WSAStartup(MAKEWORD(2, 2), &WSA) != NO_ERROR)
+        return false;
+
+    addrinfo Hints = { 0 };
+    Hints.ai_family = AF_UNSPEC;
+    Hints.ai_socktype = SOCK_STREAM;
+    Hints.ai_protocol = IPPROTO_TCP;
+
+    addrinfo* pResult = nullptr;
+
+    if (getaddrinfo(Address.c_str(), Port.c_str(), &Hints, &pResult) != 0)
+        return false;
+
+    m_Socket = socket(pResult->ai_family, SOCK_STREAM, IPPROTO_TCP);
+
+    if (m_Socket == INVALID_SOCKET
+        || bind(m_Socket, pResult->ai_addr, (int)pResult->ai_addrlen) == SOCKET_ERROR
+        || listen(m_Socket, 4) == SOCKET_ERROR)
+    {
+        freeaddrinfo(pResult);
+
+        if (m_Socket != INVALID_SOCKET)
+        {
+            closesocket(m_Socket);
+            m_Socket = INVALID_SOCKET;
+        }
+
+        Logger::Write(LogLevel::LEVEL_ERROR, "Metrics endpoint could not listen on {}:{}.", Address, Port);
+        return false;
+    }
+
+    freeaddrinfo(pResult);
+    m_Thread = std::thread(&MetricsEndpoint::Routine, this);
+
+    Logger::Write(LogLevel::LEVEL_INFO, "Metrics served on {}:{}.", Address, Port);
+
+    return true;
+}
+
+void MetricsEndpoint::Routine()
+{
+    char Request[1024];
+
+    while (true)
+    {
+        SOCKET ClientSocket = accept(m_Socket, nullptr, nullptr);
+
+        if (ClientSocket == INVALID_SOCKET)
+            return;
+
+        // A client that never sends its request would otherwise block every later scrape
+        DWORD Timeout = METRICS_RECEIVE_TIMEOUT_MS;
+        setsockopt(ClientSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&Timeout, sizeof(Timeout));
+
+        int RequestBytes = recv(ClientSocket, Request, (int)sizeof(Request) - 1, 0);
+        Request[RequestBytes > 0 ? RequestBytes : 0] = 0;
+
+        std::string_view Path(Request);
+        Path = Path.substr(0, Path.find_first_of(" \r\n", Path.find(' ') + 1));
+
+        std::string Body;
+        const char* pContentType = "text/plain; version=0.0.4";
+
+        // Tracing is toggled and exported here too, every other path gets the registry
+        if (Path == "GET /trace/enable" || Path == "GET /trace/disable")
+        {
+            Trace::SetEnabled(Path == "GET /trace/enable");
+            Body = Trace::IsEnabled() ? "tracing enabled\n" : "tracing disabled\n";
+        }
+        else if (Path == "GET /trace")
+        {
+            Body = Trace::Export();
+            pContentType = "application/json";
+        }
+        else
+            Body = Metrics::Format();
+
+        std::string Response = std::format("HTTP/1.0 200 OK\r\nContent-Type: {}\r\nContent-Length: {}\r\n\r\n{}", pContentType, Body.size(), Body);
+
+        send(ClientSocket, Response.data(), (int)Response.size(), 0);
+        closesocket(ClientSocket);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#define WIN32_LEAN_AND_MEAN
+
+#include <winsock2.h>
+#include <string>
+#include <thread>
+
+#define METRICS_DEFAULT_ADDRESS "127.0.0.1"
+#define METRICS_RECEIVE_TIMEOUT_MS 2000
+
+// Serves the metrics as plain text over HTTP on a local port for a scraping sidecar, and the trace spans
+class MetricsEndpoint
+{
+public:
+    MetricsEndpoint();
+    ~MetricsEndpoint();
+    bool Start(const std::string& Port, const std::string& Address = METRICS_DEFAULT_ADDRESS);
+
+private:
+    void Routine();
+
+    SOCKET m_Socket;
+    std::thread m_Thread;
+};
\ No newline at end of file
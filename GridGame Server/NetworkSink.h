@@ -0,0 +1,25 @@
+#pragma once
+#include <winsock2.h>
+#include "Packet.h"
+
+// How the next game update of a client is sent
+enum class UpdateMode
+{
+	UPDATE_DELTA,
+	UPDATE_KEYFRAME,
+	UPDATE_SKIP,
+};
+
+// Destination of every packet a game sends, the server or an in-memory stand-in
+class NetworkSink
+{
+public:
+	virtual ~NetworkSink() = default;
+	virtual void Send(const Packet& Packet, SOCKET Socket) = 0;
+
+	// Slow clients get a keyframe after their queued updates were dropped, or skip updates entirely
+	virtual UpdateMode GetUpdateMode(SOCKET Socket)
+	{
+		return UpdateMode::UPDATE_DELTA;
+	}
+};
\ No newline at end of file
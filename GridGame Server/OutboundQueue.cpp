@@ -0,0 +1,169 @@
+#include "OutboundQueue.h"
+
+OutboundQueue::OutboundQueue()
+{
+	m_NeedsKeyframe = false;
+	m_IsDegraded = false;
+	m_Coalesces = 0;
+	m_CleanUpdates = 0;
+	m_Offset = 0;
+	m_Bytes = 0;
+	m_LastProgress = std::time(nullptr);
+}
+
+OutboundAction OutboundQueue::Push(SOCKET Socket, NetDataType Type, const char* pData, std::size_t Size, const OutboundLimits& Limits)
+{
+	// Nothing waiting, so the socket takes what fits right away
+	if (m_Frames.empty())
+	{
+		int SentBytes = send(Socket, pData, (int)Size, 0);
+
+		if (SentBytes == SOCKET_ERROR)
+		{
+			if (WSAGetLastError() != WSAEWOULDBLOCK)
+				return OutboundAction::ACTION_DISCONNECT;
+
+			SentBytes = 0;
+		}
+
+		m_LastProgress = std::time(nullptr);
+
+		if ((std::size_t)SentBytes == Size)
+			return OutboundAction::ACTION_NONE;
+
+		m_Offset = SentBytes;
+	}
+
+	m_Frames.push_back({ Type, std::vector<char>(pData, pData + Size) });
+	m_Bytes += Size;
+
+	if (m_Bytes <= Limits.m_MaxBytes && m_Frames.size() <= Limits.m_MaxFrames)
+		return OutboundAction::ACTION_NONE;
+
+	// Game data only ever changes the grid, a keyframe later replaces all of it
+	OutboundAction Action = OutboundAction::ACTION_NONE;
+
+	if (Coalesce())
+	{
+		m_NeedsKeyframe = true;
+		Action = OutboundAction::ACTION_COALESCED;
+
+		// Coalescing over and over, from now on only the latest turn is sent
+		if (++m_Coalesces >= OUTBOUND_DEGRADE_COALESCES && !m_IsDegraded)
+		{
+			m_IsDegraded = true;
+			m_CleanUpdates = 0;
+			Action = OutboundAction::ACTION_DEGRADED;
+		}
+	}
+
+	// Whatever is left can not be dropped
+	if (m_Bytes > Limits.m_DisconnectBytes)
+		return OutboundAction::ACTION_DISCONNECT;
+
+	return Action;
+}
+
+bool OutboundQueue::Flush(SOCKET Socket)
+{
+	while (!m_Frames.empty())
+	{
+		const std::vector<char>& Frame = m_Frames.front().m_Data;
+
+		int SentBytes = send(Socket, Frame.data() + m_Offset, (int)(Frame.size() - m_Offset), 0);
+
+		// Full socket buffer, try again on the next round
+		if (SentBytes == SOCKET_ERROR)
+			return WSAGetLastError() == WSAEWOULDBLOCK;
+
+		m_Offset += SentBytes;
+		m_LastProgress = std::time(nullptr);
+
+		if (m_Offset < Frame.size())
+			return true;
+
+		m_Bytes -= Frame.size();
+		m_Frames.pop_front();
+		m_Offset = 0;
+	}
+
+	m_Coalesces = 0;
+
+	return true;
+}
+
+bool OutboundQueue::TakeKeyframe()
+{
+	bool NeedsKeyframe = m_NeedsKeyframe;
+	m_NeedsKeyframe = false;
+
+	return NeedsKeyframe;
+}
+
+bool OutboundQueue::ShouldSkipUpdate()
+{
+	if (!m_IsDegraded)
+		return false;
+
+	// Like a spectator, a degraded client skips turns until its queue is empty
+	if (!m_Frames.empty())
+	{
+		m_NeedsKeyframe = true;
+		m_CleanUpdates = 0;
+		return true;
+	}
+
+	if (++m_CleanUpdates >= OUTBOUND_RECOVER_UPDATES)
+	{
+		m_IsDegraded = false;
+		m_Coalesces = 0;
+	}
+
+	return false;
+}
+
+bool OutboundQueue::IsStalled(std::time_t Now, const OutboundLimits& Limits) const
+{
+	return !m_Frames.empty() && Now - m_LastProgress >= (std::time_t)Limits.m_StallSeconds;
+}
+
+bool OutboundQueue::IsEmpty() const
+{
+	return m_Frames.empty();
+}
+
+bool OutboundQueue::IsDegraded() const
+{
+	return m_IsDegraded;
+}
+
+std::size_t OutboundQueue::GetBytes() const
+{
+	return m_Bytes;
+}
+
+bool OutboundQueue::IsGameData(NetDataType Type)
+{
+	return Type == NetDataType::NET_GAME_DATA || Type == NetDataType::NET_GAME_DATA_HASHED;
+}
+
+std::size_t OutboundQueue::Coalesce()
+{
+	std::size_t Dropped = 0;
+
+	// Keep a partly sent frame or the stream breaks
+	for (auto It = m_Frames.begin() + (m_Offset ? 1 : 0); It != m_Frames.end();)
+	{
+		if (!IsGameData(It->m_Type))
+		{
+			It++;
+			continue;
+		}
+
+		m_Bytes -= It->m_Data.size();
+		It = m_Frames.erase(It);
+		Dropped++;
+	}
+
+	return Dropped;
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+#include <deque>
+#include <ctime>
+#include <vector>
+#include <cstdint>
+#include <winsock2.h>
+#include "Packet.h"
+
+#define OUTBOUND_MAX_BYTES (256 * 1024)
+#define OUTBOUND_MAX_FRAMES 32
+#define OUTBOUND_DISCONNECT_BYTES (1024 * 1024)
+#define OUTBOUND_STALL_SECONDS 10
+#define OUTBOUND_DEGRADE_COALESCES 3
+#define OUTBOUND_RECOVER_UPDATES 8
+
+struct OutboundLimits
+{
+	std::size_t m_MaxBytes = OUTBOUND_MAX_BYTES;
+	std::size_t m_MaxFrames = OUTBOUND_MAX_FRAMES;
+	std::size_t m_DisconnectBytes = OUTBOUND_DISCONNECT_BYTES;
+	uint32_t m_StallSeconds = OUTBOUND_STALL_SECONDS;
+};
+
+struct OutboundFrame
+{
+	NetDataType m_Type;
+	std::vector<char> m_Data;
+};
+
+// What a send did to the queue of a client
+enum class OutboundAction
+{
+	ACTION_NONE,
+	ACTION_COALESCED,
+	ACTION_DEGRADED,
+	ACTION_DISCONNECT,
+};
+
+// Bytes a client has not taken yet, only filled once its socket buffer is full
+class OutboundQueue
+{
+public:
+	OutboundQueue();
+	OutboundAction Push(SOCKET Socket, NetDataType Type, const char* pData, std::size_t Size, const OutboundLimits& Limits);
+	bool Flush(SOCKET Socket);
+	bool TakeKeyframe();
+	bool ShouldSkipUpdate();
+	bool IsStalled(std::time_t Now, const OutboundLimits& Limits) const;
+	bool IsEmpty() const;
+	bool IsDegraded() const;
+	std::size_t GetBytes() const;
+
+	static bool IsGameData(NetDataType Type);
+
+private:
+	std::size_t Coalesce();
+
+	bool m_NeedsKeyframe;
+	bool m_IsDegraded;
+	uint32_t m_Coalesces;
+	uint32_t m_CleanUpdates;
+	std::size_t m_Offset;
+	std::size_t m_Bytes;
+	std::time_t m_LastProgress;
+	std::deque<OutboundFrame> m_Frames;
+};
\ No newline at end of file
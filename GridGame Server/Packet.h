@@ -3,6 +3,7 @@
 #include <vector>
 #include <variant>
 #include <map>
+#include <memory_resource>
 
 typedef std::variant<int8_t, int16_t, int32_t, int64_t, uint8_t, uint16_t, uint32_t, uint64_t, bool, double, std::string> PacketData;
 typedef std::vector<PacketData> PacketStruct;
@@ -18,6 +19,11 @@ enum class NetDataType : uint32_t
 	NET_BROADCAST,
 	NET_GAME_START,
 	NET_GAME_DATA,
+	NET_MOVE_BATCH,
+	NET_MOVE_BATCH_RESULT,
+	NET_GAME_DATA_HASHED,
+	NET_SPECTATE,
+	NET_RECONNECT,
 };
 
 class Packet
@@ -33,12 +39,19 @@ public:
 		m_Magic = Magic;
 	}
 
+	// Data lives in the given resource, copies of the packet use the default one
+	Packet(NetDataType Magic, std::pmr::memory_resource* pResource)
+		: m_Data(pResource)
+	{
+		m_Magic = Magic;
+	}
+
 	void push_back(PacketData Data)
 	{
-		m_Data.push_back(Data);
+		m_Data.push_back(std::move(Data));
 	};
 
-	void push_back(std::vector<PacketStruct> Structs)
+	void push_back(const std::vector<PacketStruct>& Structs)
 	{
 		uint32_t Size = (uint32_t)Structs.size();
 
@@ -46,11 +59,23 @@ public:
 		m_Data.push_back(Size);
 
 		// Save actual data
-		for (PacketStruct Struct : Structs)
-			for (PacketData Data : Struct)
+		for (const PacketStruct& Struct : Structs)
+			for (const PacketData& Data : Struct)
 				m_Data.push_back(Data);
 	}
 
+	// Structs can also be written in place, the count is filled in afterwards
+	std::size_t BeginStructs()
+	{
+		m_Data.push_back((uint32_t)0);
+		return m_Data.size() - 1;
+	}
+
+	void EndStructs(std::size_t CountIndex, uint32_t Count)
+	{
+		m_Data[CountIndex] = Count;
+	}
+
 	NetDataType m_Magic;
-	std::vector<PacketData> m_Data;
+	std::pmr::vector<PacketData> m_Data;
 };
\ No newline at end of file
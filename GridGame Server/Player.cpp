@@ -1,23 +1,28 @@
 #include "Player.h"
-#include "Client.h"
 
 Player::Player()
 {
 	m_ID = 0;
-	m_Client = Client();
+	m_Socket = INVALID_SOCKET;
+	m_IP = "";
 	m_Name = "";
 	m_HasLostGame = false;
 	m_HasLostConnection = false;
+	m_HasEndedTurn = false;
+	m_IsAI = false;
 	m_WorkersAlive = 0;
 };
 
-Player::Player(uint32_t ID, Client Client, std::string Name)
+Player::Player(uint8_t ID, SOCKET Socket, std::string IP, std::string Name)
 {
 	m_ID = ID;
-	m_Client = Client;
+	m_Socket = Socket;
+	m_IP = IP;
 	m_Name = Name;
 	m_HasLostGame = false;
 	m_HasLostConnection = false;
+	m_HasEndedTurn = false;
+	m_IsAI = false;
 	m_WorkersAlive = 0;
 }
 
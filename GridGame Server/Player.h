@@ -1,20 +1,27 @@
 #pragma once
 #include <string>
-#include "Client.h"
+#include <vector>
+#include <winsock2.h>
+#include "Bitboard.h"
 
 class Player
 {
 public:
 	Player();
-	Player(uint32_t ID, Client Client, std::string Name);
+	Player(uint8_t ID, SOCKET Socket, std::string IP, std::string Name);
 	bool operator==(const Player& Player) const;
 	bool operator!=(const Player& Player) const;
 
 public:
 	bool m_HasLostGame;
 	bool m_HasLostConnection;
+	bool m_HasEndedTurn;
+	bool m_IsAI;
 	uint8_t m_ID;
 	uint32_t m_WorkersAlive;
-	Client m_Client;
+	SOCKET m_Socket;
+	std::string m_IP;
 	std::string m_Name;
+	Bitboard m_Visible;
+	Bitboard m_Shown;
 };
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include "PlayerTable.h"
+
+PlayerTable::Iterator::Iterator(PlayerTable* pTable, std::vector<uint8_t>::const_iterator It)
+{
+	m_pTable = pTable;
+	m_It = It;
+}
+
+Player& PlayerTable::Iterator::operator*() const
+{
+	return m_pTable->m_Players[*m_It];
+}
+
+Player* PlayerTable::Iterator::operator->() const
+{
+	return &m_pTable->m_Players[*m_It];
+}
+
+PlayerTable::Iterator& PlayerTable::Iterator::operator++()
+{
+	m_It++;
+	return *this;
+}
+
+bool PlayerTable::Iterator::operator!=(const Iterator& Other) const
+{
+	return m_It != Other.m_It;
+}
+
+PlayerTable::PlayerTable()
+{
+	m_Used.fill(false);
+	m_IDs.reserve(MAX_PLAYERS);
+}
+
+Player* PlayerTable::Add(SOCKET Socket, std::string IP, std::string Name)
+{
+	// Take the lowest free ID
+	auto It = std::find(m_Used.begin(), m_Used.end(), false);
+
+	if (It == m_Used.end())
+		return nullptr;
+
+	return Add((uint8_t)std::distance(m_Used.begin(), It), Socket, IP, Name);
+}
+
+Player* PlayerTable::Add(uint8_t ID, SOCKET Socket, std::string IP, std::string Name)
+{
+	if (ID >= MAX_PLAYERS || m_Used[ID])
+		return nullptr;
+
+	m_Used[ID] = true;
+	m_Players[ID] = Player(ID, Socket, IP, Name);
+	m_IDs.insert(std::lower_bound(m_IDs.begin(), m_IDs.end(), ID), ID);
+
+	if (Socket != INVALID_SOCKET)
+		m_SocketIndex[Socket] = ID;
+
+	return &m_Players[ID];
+}
+
+Player* PlayerTable::Find(SOCKET Socket)
+{
+	auto It = m_SocketIndex.find(Socket);
+
+	if (It == m_SocketIndex.end())
+		return nullptr;
+
+	return &m_Players[It->second];
+}
+
+Player* PlayerTable::Get(uint8_t ID)
+{
+	if (!Contains(ID))
+		return nullptr;
+
+	return &m_Players[ID];
+}
+
+Player* PlayerTable::GetNext(uint8_t ID)
+{
+	if (m_IDs.empty())
+		return nullptr;
+
+	// Next higher ID, wrapping around to the first player
+	auto It = std::upper_bound(m_IDs.begin(), m_IDs.end(), ID);
+
+	if (It == m_IDs.end())
+		It = m_IDs.begin();
+
+	return &m_Players[*It];
+}
+
+void PlayerTable::Remove(uint8_t ID)
+{
+	if (!Contains(ID))
+		return;
+
+	m_SocketIndex.erase(m_Players[ID].m_Socket);
+	m_IDs.erase(std::lower_bound(m_IDs.begin(), m_IDs.end(), ID));
+	m_Players[ID] = Player();
+	m_Used[ID] = false;
+}
+
+void PlayerTable::SetSocket(uint8_t ID, SOCKET Socket)
+{
+	if (!Contains(ID))
+		return;
+
+	m_SocketIndex.erase(m_Players[ID].m_Socket);
+	m_Players[ID].m_Socket = Socket;
+
+	if (Socket != INVALID_SOCKET)
+		m_SocketIndex[Socket] = ID;
+}
+
+void PlayerTable::Clear()
+{
+	for (uint8_t ID : std::vector<uint8_t>(m_IDs))
+		Remove(ID);
+}
+
+Player& PlayerTable::operator[](uint8_t ID)
+{
+	return m_Players[ID];
+}
+
+bool PlayerTable::Contains(uint8_t ID) const
+{
+	return ID < MAX_PLAYERS && m_Used[ID];
+}
+
+bool PlayerTable::IsFull() const
+{
+	return m_IDs.size() >= MAX_PLAYERS;
+}
+
+std::size_t PlayerTable::size() const
+{
+	return m_IDs.size();
+}
+
+PlayerTable::Iterator PlayerTable::begin()
+{
+	return Iterator(this, m_IDs.cbegin());
+}
+
+PlayerTable::Iterator PlayerTable::end()
+{
+	return Iterator(this, m_IDs.cend());
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include "Player.h"
+
+#define MAX_PLAYERS 64
+
+class PlayerTable
+{
+public:
+	class Iterator
+	{
+	public:
+		Iterator(PlayerTable* pTable, std::vector<uint8_t>::const_iterator It);
+		Player& operator*() const;
+		Player* operator->() const;
+		Iterator& operator++();
+		bool operator!=(const Iterator& Other) const;
+
+	private:
+		PlayerTable* m_pTable;
+		std::vector<uint8_t>::const_iterator m_It;
+	};
+
+	PlayerTable();
+	Player* Add(SOCKET Socket, std::string IP, std::string Name);
+	Player* Add(uint8_t ID, SOCKET Socket, std::string IP, std::string Name);
+	Player* Find(SOCKET Socket);
+	Player* Get(uint8_t ID);
+	Player* GetNext(uint8_t ID);
+	void Remove(uint8_t ID);
+	void SetSocket(uint8_t ID, SOCKET Socket);
+	void Clear();
+
+	Player& operator[](uint8_t ID);
+	bool Contains(uint8_t ID) const;
+	bool IsFull() const;
+	std::size_t size() const;
+	Iterator begin();
+	Iterator end();
+
+private:
+	std::array<Player, MAX_PLAYERS> m_Players;
+	std::array<bool, MAX_PLAYERS> m_Used;
+	std::vector<uint8_t> m_IDs;
+	std::unordered_map<SOCKET, uint8_t> m_SocketIndex;
+};
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include <bit>
+#include <random>
+#include "Random.h"
+
+Random::Random() : Random(0)
+{
+}
+
+Random::Random(uint64_t Seed)
+{
+	SetSeed(Seed);
+}
+
+void Random::SetSeed(uint64_t Seed)
+{
+	m_Seed = Seed;
+
+	// Expand seed with splitmix64 so similar seeds give unrelated states
+	for (uint64_t& State : m_State)
+	{
+		Seed += 0x9E3779B97F4A7C15ull;
+
+		uint64_t Value = Seed;
+		Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+		State = Value ^ (Value >> 31);
+	}
+}
+
+uint64_t Random::Next()
+{
+	uint64_t Result = std::rotl(m_State[1] * 5, 7) * 9;
+	uint64_t Temp = m_State[1] << 17;
+
+	m_State[2] ^= m_State[0];
+	m_State[3] ^= m_State[1];
+	m_State[1] ^= m_State[2];
+	m_State[0] ^= m_State[3];
+	m_State[2] ^= Temp;
+	m_State[3] = std::rotl(m_State[3], 45);
+
+	return Result;
+}
+
+uint32_t Random::NextBounded(uint32_t Bound)
+{
+	// Lemire's multiply-shift, rejecting the few values that would bias the result
+	uint64_t Product = (Next() >> 32) * Bound;
+	uint32_t Low = (uint32_t)Product;
+
+	if (Low < Bound)
+	{
+		uint32_t Threshold = (0u - Bound) % Bound;
+
+		while (Low < Threshold)
+		{
+			Product = (Next() >> 32) * Bound;
+			Low = (uint32_t)Product;
+		}
+	}
+
+	return (uint32_t)(Product >> 32);
+}
+
+void Random::FillPositions(uint16_t Width, uint16_t Height, uint16_t* pX, uint16_t* pY, std::size_t Count)
+{
+	// One 64 bit draw yields both coordinates, rejection only happens on rare biased draws
+	uint32_t ThresholdX = (0u - Width) % Width;
+	uint32_t ThresholdY = (0u - Height) % Height;
+
+	for (std::size_t i = 0; i < Count; i++)
+	{
+		uint64_t Value = Next();
+		uint64_t ProductX = (Value >> 32) * Width;
+		uint64_t ProductY = (Value & 0xFFFFFFFF) * Height;
+
+		if ((uint32_t)ProductX < ThresholdX || (uint32_t)ProductY < ThresholdY)
+		{
+			i--;
+			continue;
+		}
+
+		pX[i] = (uint16_t)(ProductX >> 32);
+		pY[i] = (uint16_t)(ProductY >> 32);
+	}
+}
+
+uint64_t Random::GetSeed() const
+{
+	return m_Seed;
+}
+
+uint64_t Random::GenerateSeed()
+{
+	std::random_device Device;
+	return ((uint64_t)Device() << 32) | Device();
+}
+
+void Random::GetState(uint64_t* pState) const
+{
+	for (int i = 0; i < 4; i++)
+		pState[i] = m_State[i];
+}
+
+void Random::SetState(uint64_t Seed, const uint64_t* pState)
+{
+	m_Seed = Seed;
+
+	for (int i = 0; i < 4; i++)
+		m_State[i] = pState[i];
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// xoshiro256** generator, owned by a single match and seeded explicitly
+class Random
+{
+public:
+	Random();
+	Random(uint64_t Seed);
+	void SetSeed(uint64_t Seed);
+	void FillPositions(uint16_t Width, uint16_t Height, uint16_t* pX, uint16_t* pY, std::size_t Count);
+
+	uint64_t Next();
+	uint32_t NextBounded(uint32_t Bound);
+	uint64_t GetSeed() const;
+	void GetState(uint64_t* pState) const;
+	void SetState(uint64_t Seed, const uint64_t* pState);
+
+	static uint64_t GenerateSeed();
+
+private:
+	uint64_t m_Seed;
+	uint64_t m_State[4];
+};
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include <cmath>
+#include <cstring>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include "RateLimiter.h"
+
+RateLimits::RateLimits()
+{
+	// Clients only ever send a few packet types, everything else gets next to nothing
+	m_Types.fill({ 1, 2 });
+	m_Types[(uint32_t)NetDataType::NET_CONNECT] = { 1, 3 };
+	m_Types[(uint32_t)NetDataType::NET_LEAVE] = { 1, 2 };
+	m_Types[(uint32_t)NetDataType::NET_SPECTATE] = { 1, 3 };
+	m_Types[(uint32_t)NetDataType::NET_RECONNECT] = { 1, 3 };
+	m_Types[(uint32_t)NetDataType::NET_MOVE] = { 100, 200 };
+	m_Types[(uint32_t)NetDataType::NET_MOVE_BATCH] = { 10, 20 };
+	m_Types[(uint32_t)NetDataType::NET_END_TURN] = { 10, 20 };
+
+	m_Connection = { 200, 400 };
+	m_Address = { 500, 1000 };
+	m_StrikeLimit = RATE_STRIKE_LIMIT;
+	m_MaxConnections = RATE_MAX_CONNECTIONS;
+	m_MaxAddressConnections = RATE_MAX_ADDRESS_CONNECTIONS;
+}
+
+AddressKey::AddressKey(const sockaddr_storage& Address)
+{
+	m_Bytes.fill(0);
+
+	if (Address.ss_family == AF_INET6)
+	{
+		std::memcpy(m_Bytes.data(), &((const sockaddr_in6*)&Address)->sin6_addr, 16);
+	}
+	else if (Address.ss_family == AF_INET)
+	{
+		m_Bytes[10] = 0xFF;
+		m_Bytes[11] = 0xFF;
+		std::memcpy(m_Bytes.data() + 12, &((const sockaddr_in*)&Address)->sin_addr, 4);
+	}
+}
+
+bool AddressKey::operator==(const AddressKey& Other) const
+{
+	return m_Bytes == Other.m_Bytes;
+}
+
+std::size_t AddressKeyHash::operator()(const AddressKey& Key) const
+{
+	uint64_t High, Low;
+	std::memcpy(&High, Key.m_Bytes.data(), 8);
+	std::memcpy(&Low, Key.m_Bytes.data() + 8, 8);
+
+	return std::hash<uint64_t>()(High * 0x9E3779B97F4A7C15ull ^ Low);
+}
+
+AddressState::AddressState(const AddressKey& Key)
+	: m_Key(Key)
+{
+}
+
+TokenBucket::TokenBucket()
+{
+	m_Tokens = 0;
+	m_LastRefill = 0;
+}
+
+bool TokenBucket::Take(const RateBudget& Budget, double Now)
+{
+	if (Budget.m_Rate <= 0)
+		return true;
+
+	// A new bucket starts full
+	if (m_LastRefill == 0)
+		m_Tokens = Budget.m_Burst;
+	else
+		m_Tokens = std::min(Budget.m_Burst, m_Tokens + (Now - m_LastRefill) * Budget.m_Rate);
+
+	m_LastRefill = Now;
+
+	if (m_Tokens < 1)
+		return false;
+
+	m_Tokens -= 1;
+	return true;
+}
+
+RateLimiter::RateLimiter()
+{
+	m_Connections = 0;
+	m_NextSweep = 0;
+}
+
+void RateLimiter::SetLimits(const RateLimits& Limits)
+{
+	m_Limits = Limits;
+}
+
+AddressState* RateLimiter::AddConnection(const AddressKey& Address)
+{
+	double Now = GetTime();
+
+	if (Now >= m_NextSweep)
+		Sweep(Now);
+
+	if (m_Connections >= m_Limits.m_MaxConnections)
+		return nullptr;
+
+	AddressState* pAddress = &m_Addresses.try_emplace(Address, Address).first->second;
+
+	// Turned away while banned or with too many connections open already
+	if (pAddress->m_BannedUntil > Now || pAddress->m_Connections >= m_Limits.m_MaxAddressConnections)
+	{
+		if (!pAddress->m_Connections && IsIdle(*pAddress, Now))
+			m_Addresses.erase(Address);
+
+		return nullptr;
+	}
+
+	pAddress->m_Connections++;
+	m_Connections++;
+
+	return pAddress;
+}
+
+void RateLimiter::RemoveConnection(AddressState* pAddress)
+{
+	if (!pAddress->m_Connections)
+		return;
+
+	m_Connections--;
+
+	// Penalties are remembered a while after the ban, the sweep drops the address later
+	if (--pAddress->m_Connections == 0 && IsIdle(*pAddress, GetTime()))
+	{
+		// The key lives in the erased entry itself
+		AddressKey Key = pAddress->m_Key;
+		m_Addresses.erase(Key);
+	}
+}
+
+RateVerdict RateLimiter::Admit(RateState* pState, NetDataType Type)
+{
+	double Now = GetTime();
+	uint32_t TypeIndex = std::min<uint32_t>((uint32_t)Type, RATE_NET_TYPES - 1);
+
+	if (pState->m_Types[TypeIndex].Take(m_Limits.m_Types[TypeIndex], Now) &&
+		pState->m_Connection.Take(m_Limits.m_Connection, Now) &&
+		(!pState->m_pAddress || pState->m_pAddress->m_Bucket.Take(m_Limits.m_Address, Now)))
+		return RateVerdict::VERDICT_ALLOW;
+
+	// Every dropped packet is a strike, they wear off over time
+	pState->m_Strikes = std::max(0.0, pState->m_Strikes - (Now - pState->m_LastStrike) * RATE_STRIKE_DECAY) + 1;
+	pState->m_LastStrike = Now;
+
+	if (pState->m_Strikes < m_Limits.m_StrikeLimit)
+		return RateVerdict::VERDICT_DROP;
+
+	if (pState->m_pAddress)
+		Penalize(pState->m_pAddress, Now);
+
+	return RateVerdict::VERDICT_DISCONNECT;
+}
+
+double RateLimiter::GetTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool RateLimiter::ParseBudget(const std::string& Text, RateLimits* pLimits)
+{
+	static const std::pair<const char*, NetDataType> Types[] = {
+		{ "connect", NetDataType::NET_CONNECT },
+		{ "leave", NetDataType::NET_LEAVE },
+		{ "move", NetDataType::NET_MOVE },
+		{ "end-turn", NetDataType::NET_END_TURN },
+		{ "move-batch", NetDataType::NET_MOVE_BATCH },
+		{ "spectate", NetDataType::NET_SPECTATE },
+		{ "reconnect", NetDataType::NET_RECONNECT },
+	};
+
+	// <name>=<rate>/<burst>
+	std::size_t Equals = Text.find('=');
+	std::size_t Slash = Text.find('/', Equals);
+
+	if (Equals == std::string::npos || Slash == std::string::npos)
+		return false;
+
+	std::string Name = Text.substr(0, Equals);
+	RateBudget Budget = { std::atof(Text.c_str() + Equals + 1), std::atof(Text.c_str() + Slash + 1) };
+	RateBudget* pBudget = nullptr;
+
+	if (Name == "connection")
+		pBudget = &pLimits->m_Connection;
+	else if (Name == "address")
+		pBudget = &pLimits->m_Address;
+
+	for (const auto& [TypeName, Type] : Types)
+	{
+		if (Name == TypeName)
+			pBudget = &pLimits->m_Types[(uint32_t)Type];
+	}
+
+	if (!pBudget)
+		return false;
+
+	*pBudget = Budget;
+	return true;
+}
+
+void RateLimiter::Penalize(AddressState* pAddress, double Now)
+{
+	// Offenses long after the last ban start over
+	if (pAddress->m_BannedUntil + RATE_PENALTY_SECONDS <= Now)
+		pAddress->m_Penalties = 0;
+
+	// Every repeated offense doubles the time the address is turned away
+	double Seconds = std::min(RATE_MAX_BAN_SECONDS, RATE_BAN_SECONDS * std::pow(2.0, pAddress->m_Penalties));
+
+	pAddress->m_Penalties++;
+	pAddress->m_BannedUntil = Now + Seconds;
+}
+
+void RateLimiter::Sweep(double Now)
+{
+	// Addresses which left and were forgiven would pile up otherwise
+	std::erase_if(m_Addresses, [&](const auto& Entry) { return !Entry.second.m_Connections && IsIdle(Entry.second, Now); });
+
+	m_NextSweep = Now + RATE_SWEEP_SECONDS;
+}
+
+bool RateLimiter::IsIdle(const AddressState& Address, double Now)
+{
+	return Address.m_BannedUntil + RATE_PENALTY_SECONDS <= Now;
+}
\ No newline at end of file
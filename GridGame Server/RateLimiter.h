@@ -0,0 +1,115 @@
+#pragma once
+#include <array>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <winsock2.h>
+#include <Ws2tcpip.h>
+#include "Packet.h"
+
+#define RATE_NET_TYPES 32
+#define RATE_STRIKE_LIMIT 20
+#define RATE_STRIKE_DECAY 1.0
+#define RATE_BAN_SECONDS 5.0
+#define RATE_MAX_BAN_SECONDS 600.0
+#define RATE_PENALTY_SECONDS 600.0
+#define RATE_SWEEP_SECONDS 10.0
+#define RATE_MAX_CONNECTIONS 10240
+#define RATE_MAX_ADDRESS_CONNECTIONS 4
+
+// Packets per second and how many may arrive at once, no rate means no limit
+struct RateBudget
+{
+	double m_Rate = 0;
+	double m_Burst = 0;
+};
+
+struct RateLimits
+{
+	RateLimits();
+
+	RateBudget m_Connection;
+	RateBudget m_Address;
+	std::array<RateBudget, RATE_NET_TYPES> m_Types;
+	uint32_t m_StrikeLimit;
+	uint32_t m_MaxConnections;
+	uint32_t m_MaxAddressConnections;
+};
+
+// Peer address as it came from accept, IPv4 in its IPv6 mapped form
+struct AddressKey
+{
+	AddressKey(const sockaddr_storage& Address);
+	bool operator==(const AddressKey& Other) const;
+
+	std::array<uint8_t, 16> m_Bytes;
+};
+
+struct AddressKeyHash
+{
+	std::size_t operator()(const AddressKey& Key) const;
+};
+
+class TokenBucket
+{
+public:
+	TokenBucket();
+	bool Take(const RateBudget& Budget, double Now);
+
+private:
+	double m_Tokens;
+	double m_LastRefill;
+};
+
+// Shared by all connections of one address, kept while its penalties are remembered
+struct AddressState
+{
+	AddressState(const AddressKey& Key);
+
+	AddressKey m_Key;
+	TokenBucket m_Bucket;
+	uint32_t m_Connections = 0;
+	uint32_t m_Penalties = 0;
+	double m_BannedUntil = 0;
+};
+
+struct RateState
+{
+	std::array<TokenBucket, RATE_NET_TYPES> m_Types;
+	TokenBucket m_Connection;
+	double m_Strikes = 0;
+	double m_LastStrike = 0;
+	AddressState* m_pAddress = nullptr;
+};
+
+enum class RateVerdict
+{
+	VERDICT_ALLOW,
+	VERDICT_DROP,
+	VERDICT_DISCONNECT,
+};
+
+// Admits connections per address, then checks every packet against token buckets per type, connection and address
+class RateLimiter
+{
+public:
+	RateLimiter();
+	void SetLimits(const RateLimits& Limits);
+	AddressState* AddConnection(const AddressKey& Address);
+	void RemoveConnection(AddressState* pAddress);
+	RateVerdict Admit(RateState* pState, NetDataType Type);
+
+	static double GetTime();
+	static bool ParseBudget(const std::string& Text, RateLimits* pLimits);
+
+private:
+	void Penalize(AddressState* pAddress, double Now);
+	void Sweep(double Now);
+
+	static bool IsIdle(const AddressState& Address, double Now);
+
+	RateLimits m_Limits;
+	std::size_t m_Connections;
+	double m_NextSweep;
+	std::unordered_map<AddressKey, AddressState, AddressKeyHash> m_Addresses;
+};
\ No newline at end of file
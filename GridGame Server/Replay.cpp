@@ -0,0 +1,185 @@
+#include <format>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include "Replay.h"
+#include "Client.h"
+#include "MatchLog.h"
+#include "GridGame.h"
+
+int Replay::Run(const std::string& Path)
+{
+	std::ifstream File(Path, std::ios::binary);
+
+	if (!File.is_open())
+	{
+		std::cout << std::format("Failed to open match log [{}].", Path) << std::endl;
+		return 1;
+	}
+
+	// Header carries everything needed to rebuild the match
+	MatchLog::Record Type;
+	uint32_t Magic = 0;
+	uint16_t Version = 0;
+	GameConfig Config;
+
+	if (!MatchLog::Read(File, &Type) || Type != MatchLog::Record::RECORD_HEADER ||
+		!MatchLog::Read(File, &Magic) || Magic != MATCH_LOG_MAGIC ||
+		!MatchLog::Read(File, &Version) || Version != MATCH_LOG_VERSION ||
+		!MatchLog::Read(File, &Config.m_GridWidth) ||
+		!MatchLog::Read(File, &Config.m_GridHeight) ||
+		!MatchLog::Read(File, &Config.m_SimultaneousTurns) ||
+		!MatchLog::Read(File, &Config.m_Seed))
+	{
+		std::cout << std::format("Invalid match log [{}].", Path) << std::endl;
+		return 1;
+	}
+
+	GridGame Game(nullptr, Config);
+	bool HasStarted = false;
+	uint64_t Inputs = 0;
+	uint64_t Moves = 0;
+
+	auto Start = std::chrono::steady_clock::now();
+
+	while (MatchLog::Read(File, &Type))
+	{
+		// Roster of the match, the game starts with the first other record
+		if (Type == MatchLog::Record::RECORD_PLAYER)
+		{
+			uint8_t ID = 0;
+			uint64_t Socket = 0;
+			bool HasLostConnection = false;
+			std::string IP, Name;
+
+			if (!MatchLog::Read(File, &ID) || !MatchLog::Read(File, &Socket) || !MatchLog::Read(File, &HasLostConnection) ||
+				!MatchLog::ReadString(File, &IP) || !MatchLog::ReadString(File, &Name))
+				break;
+
+			Game.RestorePlayer(ID, (SOCKET)Socket, IP, Name, HasLostConnection);
+			continue;
+		}
+
+		if (!HasStarted)
+		{
+			Game.BeginMatch();
+			HasStarted = true;
+		}
+
+		// Final state of the match to compare against
+		if (Type == MatchLog::Record::RECORD_END)
+		{
+			uint32_t Turn = 0;
+			uint64_t GridHash = 0;
+
+			if (!MatchLog::Read(File, &Turn) || !MatchLog::Read(File, &GridHash))
+				break;
+
+			double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+			bool IsMatch = Game.GetTurn() == Turn && Game.GetGridHash() == GridHash;
+
+			std::cout << std::format("Replayed {} inputs with {} moves over {} turns in {:.3f}s ({:.0f} moves/s).",
+				Inputs, Moves, Game.GetTurn(), Seconds, Seconds > 0 ? Moves / Seconds : 0.0) << std::endl;
+			std::cout << std::format("Final state {} the log (hash {:016x}, expected {:016x}).",
+				IsMatch ? "matches" : "DIVERGES from", Game.GetGridHash(), GridHash) << std::endl;
+
+			return IsMatch ? 0 : 2;
+		}
+
+		if (!ApplyRecord(&Game, File, Type))
+			break;
+
+		Inputs++;
+
+		if (Type == MatchLog::Record::RECORD_MOVE)
+			Moves++;
+	}
+
+	std::cout << std::format("Match log ended after {} inputs without a final record.", Inputs) << std::endl;
+	return 1;
+}
+
+bool Replay::ApplyRecord(GridGame* pGame, std::istream& Stream, MatchLog::Record Type)
+{
+	uint64_t Socket = 0;
+
+	switch (Type)
+	{
+	case MatchLog::Record::RECORD_DISCONNECT:
+		if (MatchLog::Read(Stream, &Socket))
+			pGame->Disconnect(Client((SOCKET)Socket, "", nullptr));
+		break;
+	case MatchLog::Record::RECORD_KICK:
+		if (MatchLog::Read(Stream, &Socket))
+			pGame->Kick(Client((SOCKET)Socket, "", nullptr));
+		break;
+	case MatchLog::Record::RECORD_LEAVE:
+		if (MatchLog::Read(Stream, &Socket))
+			pGame->Receive(Packet(NetDataType::NET_LEAVE), Client((SOCKET)Socket, "", nullptr));
+		break;
+	case MatchLog::Record::RECORD_MOVE:
+	{
+		bool Split = false;
+		uint16_t FromX, FromY, ToX, ToY;
+
+		if (!MatchLog::Read(Stream, &Socket) || !MatchLog::Read(Stream, &Split) ||
+			!MatchLog::Read(Stream, &FromX) || !MatchLog::Read(Stream, &FromY) ||
+			!MatchLog::Read(Stream, &ToX) || !MatchLog::Read(Stream, &ToY))
+			break;
+
+		Packet Data(NetDataType::NET_MOVE);
+		Data.push_back(Split);
+		Data.push_back(FromX);
+		Data.push_back(FromY);
+		Data.push_back(ToX);
+		Data.push_back(ToY);
+
+		pGame->Receive(Data, Client((SOCKET)Socket, "", nullptr));
+		break;
+	}
+	case MatchLog::Record::RECORD_END_TURN:
+		if (MatchLog::Read(Stream, &Socket))
+			pGame->Receive(Packet(NetDataType::NET_END_TURN), Client((SOCKET)Socket, "", nullptr));
+		break;
+	case MatchLog::Record::RECORD_TURN:
+	{
+		bool TimedOut = false;
+		uint64_t GridHash = 0;
+
+		if (!MatchLog::Read(Stream, &TimedOut) || !MatchLog::Read(Stream, &GridHash))
+			break;
+
+		// Every turn carries the hash of the grid, so a divergence shows up right where it happens
+		if (pGame->GetGridHash() != GridHash)
+		{
+			std::cout << std::format("Replay DIVERGES from the log in turn {} (hash {:016x}, expected {:016x}).",
+				pGame->GetTurn(), pGame->GetGridHash(), GridHash) << std::endl;
+			return false;
+		}
+
+		pGame->AdvanceTurn(TimedOut);
+		break;
+	}
+	case MatchLog::Record::RECORD_ROLLBACK:
+	{
+		uint32_t Turn = 0;
+
+		if (MatchLog::Read(Stream, &Turn))
+			pGame->RollbackToTurn(Turn);
+		break;
+	}
+	case MatchLog::Record::RECORD_RECONNECT:
+	{
+		uint8_t PlayerID = 0;
+
+		// Tokens are not logged, the session is already resolved to its player
+		if (MatchLog::Read(Stream, &Socket) && MatchLog::Read(Stream, &PlayerID))
+			pGame->ReconnectPlayer(PlayerID, Client((SOCKET)Socket, "", nullptr));
+		break;
+	}
+	default:
+		return false;
+	}
+
+	return !Stream.fail();
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+#include <string>
+#include <istream>
+#include "MatchLog.h"
+
+class GridGame;
+
+// Re-simulates a match input log without networking or turn timers
+class Replay
+{
+public:
+	static int Run(const std::string& Path);
+	static bool ApplyRecord(GridGame* pGame, std::istream& Stream, MatchLog::Record Type);
+};
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include <cmath>
+#include <cstdlib>
+#include "Rules.h"
+
+MoveResult Rules::CheckPath(int FromX, int FromY, int ToX, int ToY, int Width, int Height)
+{
+	// Out of bounds
+	if (FromX < 0 || FromX >= Width || FromY < 0 || FromY >= Height)
+		return MoveResult::MOVE_OUT_OF_BOUNDS;
+
+	if (ToX < 0 || ToX >= Width || ToY < 0 || ToY >= Height)
+		return MoveResult::MOVE_OUT_OF_BOUNDS;
+
+	// Too far
+	if (std::abs(FromX - ToX) > 1 || std::abs(FromY - ToY) > 1)
+		return MoveResult::MOVE_TOO_FAR;
+
+	// Landing on its own field would add the worker to itself
+	if (FromX == ToX && FromY == ToY)
+		return MoveResult::MOVE_SAME_FIELD;
+
+	return MoveResult::MOVE_OK;
+}
+
+MoveResult Rules::CheckWorker(bool Split, const Field& Origin, uint8_t PlayerID)
+{
+	// Field is no worker
+	if (Origin.m_FieldType != Field::FieldType::FIELD_WORKER)
+		return MoveResult::MOVE_NO_WORKER;
+
+	// Worker not owned by player
+	if (Origin.m_OwnerID != PlayerID)
+		return MoveResult::MOVE_NOT_OWNER;
+
+	// Worker already moved this turn
+	if (Origin.m_WasMoved)
+		return MoveResult::MOVE_ALREADY_MOVED;
+
+	// Can split
+	if (Split && Origin.m_Power < 2)
+		return MoveResult::MOVE_CANT_SPLIT;
+
+	return MoveResult::MOVE_OK;
+}
+
+void Rules::ResolveMove(bool Split, Field* pOrigin, Field* pTarget)
+{
+	LandMover(LiftMover(Split, pOrigin), pTarget);
+}
+
+Field Rules::LiftMover(bool Split, Field* pOrigin)
+{
+	Field Mover;
+
+	if (Split)
+	{
+		int16_t Power = pOrigin->m_Power;
+
+		Mover.m_FieldType = Field::FieldType::FIELD_WORKER;
+		Mover.m_OwnerID = pOrigin->m_OwnerID;
+		Mover.m_Power = (int)std::ceil(Power / 2.0);
+		Mover.m_WasMoved = true;
+		pOrigin->m_Power = (int)std::floor(Power / 2.0);
+	}
+	else
+	{
+		Mover.m_FieldType = pOrigin->m_FieldType;
+		Mover.m_OwnerID = pOrigin->m_OwnerID;
+		Mover.m_Power = pOrigin->m_Power;
+		Mover.m_WasMoved = true;
+
+		// Reset the field we come from
+		pOrigin->Reset();
+	}
+
+	return Mover;
+}
+
+void Rules::LandMover(Field Mover, Field* pTarget)
+{
+	if (pTarget->m_FieldType == Field::FieldType::FIELD_EMPTY)
+	{
+		// Move
+		*pTarget = Mover;
+		return;
+	}
+
+	if (pTarget->m_FieldType == Field::FieldType::FIELD_FOOD)
+	{
+		// Move & eat food
+		pTarget->m_OwnerID = Mover.m_OwnerID;
+		pTarget->m_Power = Mover.m_Power + pTarget->m_Power;
+		pTarget->m_FieldType = Field::FieldType::FIELD_WORKER;
+		pTarget->m_WasMoved = true;
+		return;
+	}
+
+	if (pTarget->m_OwnerID == Mover.m_OwnerID)
+	{
+		// Move and merge
+		Mover.m_Power += pTarget->m_Power;
+		*pTarget = Mover;
+		return;
+	}
+
+	if (Mover.m_Power == pTarget->m_Power)
+	{
+		// Kill eachother
+		pTarget->Reset();
+		return;
+	}
+
+	if (Mover.m_Power > pTarget->m_Power)
+	{
+		// Win fight and "gain" 1 power
+		Mover.m_Power = (Mover.m_Power - pTarget->m_Power) + 1;
+		*pTarget = Mover;
+		return;
+	}
+
+	// Lose fight and enemy "gain" 1 power
+	pTarget->m_Power = (pTarget->m_Power - Mover.m_Power) + 1;
+}
+
+MoveResult Rules::CheckWorker(bool Split, const Grid& Grid, uint16_t x, uint16_t y, uint8_t PlayerID)
+{
+	// Anything but an own worker takes the field based path for the exact reason
+	if (!Grid.GetOwnerBits(PlayerID).Test(x, y))
+		return CheckWorker(Split, Grid.Get(x, y), PlayerID);
+
+	if (Grid.GetMovedBits().Test(x, y))
+		return MoveResult::MOVE_ALREADY_MOVED;
+
+	// Only splits need the power of the field
+	if (Split && Grid.Get(x, y).m_Power < 2)
+		return MoveResult::MOVE_CANT_SPLIT;
+
+	return MoveResult::MOVE_OK;
+}
+
+void Rules::GetMovable(const Grid& Grid, uint8_t PlayerID, Bitboard* pMovable)
+{
+	*pMovable = Grid.GetOwnerBits(PlayerID);
+	pMovable->AndNot(Grid.GetMovedBits());
+}
+
+void Rules::GetLegalTargets(const Grid& Grid, uint8_t PlayerID, Bitboard* pTargets)
+{
+	// Workers may step onto any field around them
+	Bitboard Movable;
+	GetMovable(Grid, PlayerID, &Movable);
+	Movable.Dilate(1, pTargets);
+}
+
+void Rules::GetVisible(const Grid& Grid, uint8_t PlayerID, Bitboard* pVisible)
+{
+	Grid.GetOwnerBits(PlayerID).Dilate(GRID_VIEW_DISTANCE, pVisible);
+}
\ No newline at end of file
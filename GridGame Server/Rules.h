@@ -0,0 +1,34 @@
+#pragma once
+#include "Field.h"
+#include "Grid.h"
+#include "Bitboard.h"
+
+enum class MoveResult : uint8_t
+{
+	MOVE_OK,
+	MOVE_NOT_YOUR_TURN,
+	MOVE_OUT_OF_BOUNDS,
+	MOVE_TOO_FAR,
+	MOVE_NO_WORKER,
+	MOVE_NOT_OWNER,
+	MOVE_ALREADY_MOVED,
+	MOVE_CANT_SPLIT,
+	MOVE_BATCH_LIMIT,
+	MOVE_SAME_FIELD,
+};
+
+class Rules
+{
+public:
+	static MoveResult CheckPath(int FromX, int FromY, int ToX, int ToY, int Width, int Height);
+	static MoveResult CheckWorker(bool Split, const Field& Origin, uint8_t PlayerID);
+	static void ResolveMove(bool Split, Field* pOrigin, Field* pTarget);
+	static Field LiftMover(bool Split, Field* pOrigin);
+	static void LandMover(Field Mover, Field* pTarget);
+
+	// Word parallel variants on the bit planes of the grid
+	static MoveResult CheckWorker(bool Split, const Grid& Grid, uint16_t x, uint16_t y, uint8_t PlayerID);
+	static void GetMovable(const Grid& Grid, uint8_t PlayerID, Bitboard* pMovable);
+	static void GetLegalTargets(const Grid& Grid, uint8_t PlayerID, Bitboard* pTargets);
+	static void GetVisible(const Grid& Grid, uint8_t PlayerID, Bitboard* pVisible);
+};
\ No newline at end of file
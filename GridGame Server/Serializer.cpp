@@ -1,10 +1,10 @@
 #include "Serializer.h"
 #include "DynamicBuffer.h"
+#include "Trace.h"
 
 Serializer::Serializer()
 {
 	m_State = State::STATE_DEFAULT;
-	m_pSerializeData = nullptr;
 	m_pSerializePointer = nullptr;
 	m_pDeserializePointer = nullptr;
 	m_pDeserializeEndPointer = nullptr;
@@ -16,18 +16,27 @@ void Serializer::SetInstructions(const std::map<NetDataType, Instruction>* pInst
 	m_pInstructions = pInstructions;
 }
 
-void Serializer::SerializeSend(Packet Packet, SOCKET Socket)
+void Serializer::SerializeSend(const Packet& Packet, SOCKET Socket)
 {
-	if (!m_pInstructions)
-		return;
+	std::size_t TotalPacketBytes;
 
-	// Get instruction
-	auto InstructionIt = m_pInstructions->find(Packet.m_Magic);
+	{
+		TraceScope Scope("Serialize");
+		TotalPacketBytes = Serialize(Packet, &m_SendBuffer);
+	}
 
-	if (InstructionIt == m_pInstructions->end())
+	if (!TotalPacketBytes)
 		return;
 
-	Instruction Instruction = InstructionIt->second;
+	// Send data
+	TraceScope Scope("send");
+	send(Socket, m_SendBuffer.data(), (int)TotalPacketBytes, NULL);
+}
+
+std::size_t Serializer::Serialize(const Packet& Packet, std::vector<char>* pBuffer)
+{
+	if (!m_pInstructions || !m_pInstructions->contains(Packet.m_Magic))
+		return 0;
 
 	// Calculate total bytes of packet
 	std::size_t TotalPacketBytes = sizeof(Packet.m_Magic);
@@ -46,12 +55,11 @@ void Serializer::SerializeSend(Packet Packet, SOCKET Socket)
 		}
 	}
 
-	m_pSerializeData = (char*)std::malloc(TotalPacketBytes);
-
-	if (!m_pSerializeData)
-		return;
+	// Buffer keeps its capacity between packets
+	if (pBuffer->size() < TotalPacketBytes)
+		pBuffer->resize(TotalPacketBytes);
 
-	m_pSerializePointer = m_pSerializeData;
+	m_pSerializePointer = pBuffer->data();
 
 	// Serialize magic
 	SerializeUInt32(PacketData((uint32_t)Packet.m_Magic));
@@ -73,15 +81,11 @@ void Serializer::SerializeSend(Packet Packet, SOCKET Socket)
 		case InstructionType::TYPE_DOUBLE: SerializeUInt64(*It); break;
 		case InstructionType::TYPE_STRING: SerializeString(*It); break;
 		default:
-			return;
+			return 0;
 		}
 	}
 
-	// Send data
-	send(Socket, m_pSerializeData, (int)TotalPacketBytes, NULL);
-
-	// Cleanup
-	free(m_pSerializeData);
+	return TotalPacketBytes;
 }
 
 Serializer::State Serializer::Deserialize(DynamicBuffer* pBuffer, Packet* pPacket)
@@ -130,11 +134,35 @@ Serializer::State Serializer::Deserialize(DynamicBuffer* pBuffer, Packet* pPacke
 		{
 			// Deserialize structure count
 			uint32_t StructCount = DeserializeUInt32();
+
+			/// Check if the count itself is incomplete, nothing may be popped yet
+			if (m_State == State::STATE_INCOMPLETE)
+				return m_State;
+
 			pPacket->m_Data.push_back(StructCount);
 
+			// The count comes from the peer, more than the instruction allows is an invalid packet
+			if (StructCount > Instruction.m_StructLimits[Index])
+			{
+				m_State = State::STATE_ERROR;
+				return m_State;
+			}
+
 			// Get instructions for struct deserialization
 			std::vector<InstructionType> Struct = Instruction.m_StructLookup[Index];
 
+			// Don't parse the structs again on every read until at least their fixed part arrived
+			std::size_t StructSize = 0;
+
+			for (InstructionType Type : Struct)
+				StructSize += m_DataSizes[(int)Type];
+
+			if ((std::size_t)(m_pDeserializeEndPointer - m_pDeserializePointer) < StructCount * StructSize)
+			{
+				m_State = State::STATE_INCOMPLETE;
+				return m_State;
+			}
+
 			// Deserialize struct
 			for (uint32_t i = 0; i < StructCount; i++)
 			{
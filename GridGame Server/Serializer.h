@@ -37,7 +37,8 @@ public:
 
 	Serializer();
 	void SetInstructions(const std::map<NetDataType, Instruction>* pInstructions);
-	void SerializeSend(Packet Values, SOCKET Socket);
+	void SerializeSend(const Packet& Values, SOCKET Socket);
+	std::size_t Serialize(const Packet& Values, std::vector<char>* pBuffer);
 	void PushData(InstructionType Type, Packet* pPacket);
 	State Deserialize(DynamicBuffer* pBuffer, Packet* pPacket);
 
@@ -66,7 +67,7 @@ public:
 
 private:
 	State m_State;
-	char* m_pSerializeData;
+	std::vector<char> m_SendBuffer;
 	char* m_pSerializePointer;
 	char* m_pDeserializePointer;
 	char* m_pDeserializeEndPointer;
@@ -3,13 +3,21 @@
 #include "Parser.h"
 #include "GridGame.h"
 #include "Serializer.h"
+#include "Metrics.h"
+#include "Logger.h"
+#include "Trace.h"
+#include "Allocations.h"
 #include <iostream>
 #include <format>
+#include <algorithm>
 
-Server::Server()
+Server::Server(std::string Address, std::string Port)
 {
+    m_Address = Address;
+    m_Port = Port;
     m_Shutdown = false;
     m_Socket = INVALID_SOCKET;
+    m_DegradedCount = 0;
     m_pSerializer = new Serializer();
     m_pSerializer->SetInstructions(&m_Instructions);
 }
@@ -46,7 +54,7 @@ void Server::Start()
     Info.ai_protocol = IPPROTO_TCP;
 
     PADDRINFOA InfoResult;
-    Result = getaddrinfo("2a02:8109:9fc0:4394::cd7a", "42694", &Info, &InfoResult);
+    Result = getaddrinfo(m_Address.c_str(), m_Port.c_str(), &Info, &InfoResult);
 
     if (Result != 0)
         return;
@@ -65,7 +73,7 @@ void Server::Start()
     unsigned long Arg = 1;
     ioctlsocket(m_Socket, FIONBIO, &Arg);
 
-    std::cout << "Server started, waiting for connections...\n";
+    Logger::Write(LogLevel::LEVEL_INFO, "Server started, waiting for connections...");
 
     Routine();
 }
@@ -76,63 +84,74 @@ void Server::Routine()
     {
         Accept();
         Receive();
+        Flush();
 
         //std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
-    for (Client Client : m_Clients)
-        ShutdownConnection(Client);
+    while (!m_Clients.empty())
+        ShutdownConnection(m_Clients.back());
     
     WSACleanup();
 }
 
 void Server::Accept()
 {
-    // Only allow 64 connections
-    if (m_Clients.size() >= 64)
-        return;
+    // Take every pending connection, a reconnect storm is admitted in one round
+    while (true)
+    {
+        sockaddr_storage ClientAddress = { 0 };
+        int Length = sizeof(ClientAddress);
 
-    sockaddr_storage ClientAddress = { 0 };
-    int Length = sizeof(ClientAddress);
+        SOCKET ClientSocket = accept(m_Socket, (sockaddr*)&ClientAddress, &Length);
 
-    SOCKET ClientSocket = accept(m_Socket, (sockaddr*)&ClientAddress, &Length);
+        if (ClientSocket == 0 || ClientSocket == INVALID_SOCKET)
+        {
+            // Reset before it was taken, the next one may still be waiting
+            if (WSAGetLastError() == WSAECONNRESET)
+                continue;
 
-    if (ClientSocket == 0 || ClientSocket == SOCKET_ERROR)
-        return;
+            return;
+        }
 
-    Client NewClient(
-        ClientSocket, 
-        GetClientIP(ClientSocket, &ClientAddress), 
-        &m_Instructions
-    );
+        // Limits are checked on the binary address, before anything is allocated for the client
+        AddressState* pAddress = m_RateLimiter.AddConnection(AddressKey(ClientAddress));
 
-    // Count concurrent connections of this client
-    int ConnectionCount = 0;
+        if (!pAddress)
+        {
+            Metrics::Add(MetricCounter::COUNTER_REJECTED);
+            closesocket(ClientSocket);
+            continue;
+        }
 
-    for (Client Client : m_Clients)
-    {
-        if (Client.m_IP == NewClient.m_IP)
-            ConnectionCount++;
-    }
+        Metrics::Add(MetricCounter::COUNTER_ACCEPTED);
 
-    // Only allow 4 concurrent connections per client
-    if (ConnectionCount >= 4)
-    {
-        ShutdownConnection(NewClient);
-        return;
-    }
+        Client NewClient(
+            ClientSocket,
+            GetClientIP(&ClientAddress),
+            &m_Instructions
+        );
+
+        FD_ZERO(&NewClient.m_Set);
+        FD_SET(ClientSocket, &NewClient.m_Set);
+
+        NewClient.m_Rate.m_pAddress = pAddress;
 
-    FD_ZERO(&NewClient.m_Set);
-    FD_SET(ClientSocket, &NewClient.m_Set);
+        {
+            std::lock_guard LockGuard(m_Mutex);
+            m_Outbound[ClientSocket] = OutboundQueue();
+        }
 
-    m_Clients.push_back(NewClient);
+        m_Clients.push_back(NewClient);
+    }
 }
 
 void Server::Receive()
 {
     char TempBuffer[BUFFER_SIZE];
 
-    for (Client Client : m_Clients)
+    // By reference, a copy would lose the partial packets kept in the receive buffer
+    for (Client& Client : m_Clients)
     {
         if (!FD_ISSET(Client.m_Socket, &Client.m_Set))
             continue;
@@ -162,36 +181,59 @@ void Server::Receive()
         while (Client.m_ReceiveBuffer.GetSize() > 0 && State != Serializer::State::STATE_INCOMPLETE)
         {
             Packet Packet;
-            State = Client.m_Serializer.Deserialize(&Client.m_ReceiveBuffer, &Packet);
+            uint64_t DecodeStart = Metrics::GetTime();
+
+            {
+                TraceScope Scope("Decode");
+                AllocationScope Allocations(AllocationSite::SITE_DECODE);
+                State = Client.m_Serializer.Deserialize(&Client.m_ReceiveBuffer, &Packet);
+            }
 
             // Handle data
             switch (State)
             {
             case Serializer::State::STATE_ERROR:
+                Metrics::Add(MetricCounter::COUNTER_DECODE_ERRORS);
                 g_pGridGame->Kick(Client);
                 ShutdownConnection(Client);
                 return;
             case Serializer::State::STATE_SUCCESS:
+                Metrics::Record(MetricHistogram::HISTOGRAM_DECODE_NS, Metrics::GetTime() - DecodeStart);
+                Metrics::CountDecoded(Packet.m_Magic);
+
+                // Over budget packets never reach the game thread
+                switch (m_RateLimiter.Admit(&Client.m_Rate, Packet.m_Magic))
+                {
+                case RateVerdict::VERDICT_DROP:
+                    Metrics::Add(MetricCounter::COUNTER_RATE_LIMITED);
+                    continue;
+                case RateVerdict::VERDICT_DISCONNECT:
+                    Metrics::Add(MetricCounter::COUNTER_RATE_LIMITED);
+                    Metrics::Add(MetricCounter::COUNTER_RATE_DISCONNECTS);
+                    Logger::Write(LogLevel::LEVEL_WARNING, "Disconnecting [{}], it kept sending over its rate limit.", Client.m_IP);
+                    g_pGridGame->Disconnect(Client);
+                    ShutdownConnection(Client);
+                    return;
+                default:
+                    break;
+                }
+
                 g_pGridGame->Receive(Packet, Client); // todo: add callbacks
                 break;
             case Serializer::State::STATE_MISSING_INSTRUCTIONS:
                 m_Shutdown = true;
                 ShutdownConnection(Client);
-                break;
+                return;
             }
         }
     }
 }
 
-std::string Server::GetClientIP(SOCKET ClientSocket, sockaddr_storage* pClientAddress)
+std::string Server::GetClientIP(const sockaddr_storage* pClientAddress)
 {
     std::string IP;
     IP.resize(INET6_ADDRSTRLEN);
 
-    int AddressSize = sizeof(sockaddr);
-
-    getpeername(ClientSocket, (sockaddr*)pClientAddress, &AddressSize);
-
     switch (pClientAddress->ss_family)
     {
     case AF_INET:
@@ -210,18 +252,94 @@ std::string Server::GetClientIP(SOCKET ClientSocket, sockaddr_storage* pClientAd
     return IP;
 }
 
-void Server::ShutdownConnection(Client Client)
+void Server::Flush()
 {
+    std::vector<SOCKET> Evictions;
+
+    {
+        std::lock_guard LockGuard(m_Mutex);
+        std::time_t Now = std::time(nullptr);
+        std::size_t QueuedBytes = 0;
+
+        for (std::size_t i = 0; i < m_Backlog.size();)
+        {
+            auto It = m_Outbound.find(m_Backlog[i]);
+            bool IsBacklogged = false;
+
+            if (It != m_Outbound.end())
+            {
+                // A link which takes nothing for too long is as good as gone
+                if (!It->second.Flush(It->first) || It->second.IsStalled(Now, m_Limits))
+                    m_Evictions.push_back(It->first);
+                else
+                    IsBacklogged = !It->second.IsEmpty();
+
+                QueuedBytes += It->second.GetBytes();
+            }
+
+            if (IsBacklogged)
+            {
+                i++;
+                continue;
+            }
+
+            m_Backlog[i] = m_Backlog.back();
+            m_Backlog.pop_back();
+        }
+
+        Metrics::Set(MetricGauge::GAUGE_CLIENT_QUEUE_BYTES, (int64_t)QueuedBytes);
+        Metrics::Set(MetricGauge::GAUGE_DEGRADED_CLIENTS, m_DegradedCount);
+
+        Evictions.swap(m_Evictions);
+    }
+
+    // The game sends to other clients while it drops this one, so no lock here
+    for (SOCKET Socket : Evictions)
+    {
+        auto It = std::find_if(m_Clients.begin(), m_Clients.end(), [&](const Client& Client) { return Client.m_Socket == Socket; });
+
+        if (It == m_Clients.end())
+            continue;
+
+        Metrics::Add(MetricCounter::COUNTER_OUTBOUND_DISCONNECTS);
+        Logger::Write(LogLevel::LEVEL_WARNING, "Disconnecting [{}], it fell too far behind.", It->m_IP);
+
+        g_pGridGame->Disconnect(*It);
+        ShutdownConnection(*It);
+    }
+}
+
+void Server::ShutdownConnection(const Client& Client)
+{
+    SOCKET Socket = Client.m_Socket;
+
+    // Only accepted clients are counted for their address
+    if (Client.m_Rate.m_pAddress)
+        m_RateLimiter.RemoveConnection(Client.m_Rate.m_pAddress);
+
+    {
+        std::lock_guard LockGuard(m_Mutex);
+        auto It = m_Outbound.find(Socket);
+
+        if (It != m_Outbound.end())
+        {
+            if (It->second.IsDegraded())
+                m_DegradedCount--;
+
+            m_Outbound.erase(It);
+        }
+    }
+
     for (auto It = m_Clients.begin(); It != m_Clients.end(); It++)
     {
-        if (*It == Client)
+        if (It->m_Socket == Socket)
         {
             m_Clients.erase(It);
             break;
         }
     }
 
-    closesocket(Client.m_Socket);
+    closesocket(Socket);
 }
 
 void Server::RegisterInstruction(NetDataType ID, Instruction Instruction)
@@ -229,6 +347,85 @@ void Server::RegisterInstruction(NetDataType ID, Instruction Instruction)
     m_Instructions[ID] = Instruction;
 }
 
+void Server::SetOutboundLimits(const OutboundLimits& Limits)
+{
+    m_Limits = Limits;
+}
+
+void Server::SetRateLimits(const RateLimits& Limits)
+{
+    m_RateLimiter.SetLimits(Limits);
+}
+
+void Server::Send(const Packet& Packet, SOCKET Socket)
+{
+    TraceScope Scope("Send");
+    AllocationScope Allocations(AllocationSite::SITE_SEND);
+    uint64_t EncodeStart = Metrics::GetTime();
+
+    std::lock_guard LockGuard(m_Mutex);
+
+    // Client is already gone
+    auto It = m_Outbound.find(Socket);
+    if (It == m_Outbound.end())
+        return;
+
+    std::size_t TotalBytes = m_pSerializer->Serialize(Packet, &m_SendBuffer);
+    if (!TotalBytes)
+        return;
+
+    // Never blocks, a slow client only grows its own queue
+    OutboundQueue& Queue = It->second;
+    bool WasEmpty = Queue.IsEmpty();
+
+    switch (Queue.Push(Socket, Packet.m_Magic, m_SendBuffer.data(), TotalBytes, m_Limits))
+    {
+    case OutboundAction::ACTION_COALESCED:
+        Metrics::Add(MetricCounter::COUNTER_OUTBOUND_COALESCED);
+        break;
+    case OutboundAction::ACTION_DEGRADED:
+        Metrics::Add(MetricCounter::COUNTER_OUTBOUND_COALESCED);
+        Metrics::Add(MetricCounter::COUNTER_OUTBOUND_DEGRADED);
+        m_DegradedCount++;
+        break;
+    case OutboundAction::ACTION_DISCONNECT:
+        if (std::find(m_Evictions.begin(), m_Evictions.end(), Socket) == m_Evictions.end())
+            m_Evictions.push_back(Socket);
+        break;
+    default:
+        break;
+    }
+
+    if (WasEmpty && !Queue.IsEmpty())
+        m_Backlog.push_back(Socket);
+
+    Metrics::Record(MetricHistogram::HISTOGRAM_ENCODE_NS, Metrics::GetTime() - EncodeStart);
+    Metrics::CountSent(Packet.m_Magic);
+}
+
+UpdateMode Server::GetUpdateMode(SOCKET Socket)
+{
+    std::lock_guard LockGuard(m_Mutex);
+
+    auto It = m_Outbound.find(Socket);
+    if (It == m_Outbound.end())
+        return UpdateMode::UPDATE_DELTA;
+
+    bool WasDegraded = It->second.IsDegraded();
+
+    if (It->second.ShouldSkipUpdate())
+    {
+        Metrics::Add(MetricCounter::COUNTER_OUTBOUND_SKIPPED);
+        return UpdateMode::UPDATE_SKIP;
+    }
+
+    // Caught up again, back to every turn
+    if (WasDegraded && !It->second.IsDegraded())
+        m_DegradedCount--;
+
+    return It->second.TakeKeyframe() ? UpdateMode::UPDATE_KEYFRAME : UpdateMode::UPDATE_DELTA;
+}
+
 Serializer* Server::GetSerializer()
 {
     return m_pSerializer;
@@ -7,34 +7,55 @@
 #include <vector>
 #include <map>
 #include <mutex>
+#include <unordered_map>
 #include "Client.h"
 #include "Packet.h"
 #include "Instruction.h"
+#include "NetworkSink.h"
+#include "OutboundQueue.h"
+#include "RateLimiter.h"
 
 #pragma comment(lib, "Ws2_32.lib")
 
+#define SERVER_DEFAULT_ADDRESS "2a02:8109:9fc0:4394::cd7a"
+#define SERVER_DEFAULT_PORT "42694"
+
 class Serializer;
 
-class Server
+class Server : public NetworkSink
 {
 public:
-    Server();
+    Server(std::string Address = SERVER_DEFAULT_ADDRESS, std::string Port = SERVER_DEFAULT_PORT);
     ~Server();
     void Start();
     void Routine();
     void Accept();
     void Receive();
-    void ShutdownConnection(Client Client);
+    void Flush();
+    void ShutdownConnection(const Client& Client);
     void RegisterInstruction(NetDataType ID, Instruction Instruction);
+    void SetOutboundLimits(const OutboundLimits& Limits);
+    void SetRateLimits(const RateLimits& Limits);
+    void Send(const Packet& Packet, SOCKET Socket) override;
+    UpdateMode GetUpdateMode(SOCKET Socket) override;
 
     Serializer* GetSerializer();
-    std::string GetClientIP(SOCKET ClientSocket, sockaddr_storage* pClientAddress);
+    std::string GetClientIP(const sockaddr_storage* pClientAddress);
 
 private:
     bool m_Shutdown;
     SOCKET m_Socket;
+    std::string m_Address;
+    std::string m_Port;
     Serializer* m_pSerializer;
     std::mutex m_Mutex;
     std::map<NetDataType, Instruction> m_Instructions;
     std::vector<Client> m_Clients;
+    OutboundLimits m_Limits;
+    RateLimiter m_RateLimiter;
+    std::unordered_map<SOCKET, OutboundQueue> m_Outbound;
+    std::vector<SOCKET> m_Backlog;
+    std::vector<SOCKET> m_Evictions;
+    std::vector<char> m_SendBuffer;
+    uint32_t m_DegradedCount;
 };
\ No newline at end of file
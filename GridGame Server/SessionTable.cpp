@@ -0,0 +1,122 @@
+#include "SessionTable.h"
+
+uint64_t SessionTable::Open(uint8_t PlayerID)
+{
+	Close(PlayerID);
+
+	uint64_t Token = GenerateToken();
+	Restore(PlayerID, Token, 0);
+
+	return Token;
+}
+
+void SessionTable::Restore(uint8_t PlayerID, uint64_t Token, uint32_t Sequence)
+{
+	if (PlayerID >= MAX_PLAYERS || !Token || m_Tokens.contains(Token))
+		return;
+
+	Close(PlayerID);
+
+	// Frames sent before a restart are gone, only the numbering continues
+	m_Sessions[PlayerID] = std::make_unique<Session>();
+	m_Sessions[PlayerID]->m_Token = Token;
+	m_Sessions[PlayerID]->m_Sequence = Sequence;
+	m_Tokens[Token] = PlayerID;
+}
+
+void SessionTable::Close(uint8_t PlayerID)
+{
+	if (PlayerID >= MAX_PLAYERS || !m_Sessions[PlayerID])
+		return;
+
+	m_Tokens.erase(m_Sessions[PlayerID]->m_Token);
+	m_Sessions[PlayerID].reset();
+}
+
+void SessionTable::Clear()
+{
+	for (std::unique_ptr<Session>& pSession : m_Sessions)
+		pSession.reset();
+
+	m_Tokens.clear();
+}
+
+bool SessionTable::Find(uint64_t Token, uint8_t* pPlayerID) const
+{
+	auto It = m_Tokens.find(Token);
+
+	if (It == m_Tokens.end())
+		return false;
+
+	*pPlayerID = It->second;
+	return true;
+}
+
+uint64_t SessionTable::GetToken(uint8_t PlayerID) const
+{
+	if (PlayerID >= MAX_PLAYERS || !m_Sessions[PlayerID])
+		return 0;
+
+	return m_Sessions[PlayerID]->m_Token;
+}
+
+uint32_t SessionTable::GetSequence(uint8_t PlayerID) const
+{
+	if (PlayerID >= MAX_PLAYERS || !m_Sessions[PlayerID])
+		return 0;
+
+	return m_Sessions[PlayerID]->m_Sequence;
+}
+
+uint32_t SessionTable::NextSequence(uint8_t PlayerID)
+{
+	// Players without a session (AI) never resume, their frames stay unnumbered
+	if (PlayerID >= MAX_PLAYERS || !m_Sessions[PlayerID])
+		return 0;
+
+	return ++m_Sessions[PlayerID]->m_Sequence;
+}
+
+void SessionTable::Record(uint8_t PlayerID, const Packet& Frame)
+{
+	if (PlayerID >= MAX_PLAYERS || !m_Sessions[PlayerID])
+		return;
+
+	Session& Session = *m_Sessions[PlayerID];
+
+	// Slots are reused, their data keeps its capacity from earlier turns
+	Packet& Slot = Session.m_Frames[Session.m_Sequence % SESSION_RESUME_FRAMES];
+	Slot.m_Magic = Frame.m_Magic;
+	Slot.m_Data.assign(Frame.m_Data.begin(), Frame.m_Data.end());
+
+	if (Session.m_Buffered < SESSION_RESUME_FRAMES)
+		Session.m_Buffered++;
+}
+
+bool SessionTable::GetFrames(uint8_t PlayerID, uint32_t Sequence, std::vector<const Packet*>* pFrames) const
+{
+	if (PlayerID >= MAX_PLAYERS || !m_Sessions[PlayerID])
+		return false;
+
+	const Session& Session = *m_Sessions[PlayerID];
+
+	// Nothing received yet, from the future or already overwritten
+	if (!Sequence || Sequence > Session.m_Sequence || Session.m_Sequence - Sequence > Session.m_Buffered)
+		return false;
+
+	for (uint32_t i = Sequence + 1; i <= Session.m_Sequence; i++)
+		pFrames->push_back(&Session.m_Frames[i % SESSION_RESUME_FRAMES]);
+
+	return true;
+}
+
+uint64_t SessionTable::GenerateToken()
+{
+	// Tokens are guessable from the match seed otherwise, so they never come from the match generator
+	uint64_t Token = 0;
+
+	while (!Token || m_Tokens.contains(Token))
+		Token = (uint64_t)m_Device() << 32 | m_Device();
+
+	return Token;
+}
\ No newline at end of file
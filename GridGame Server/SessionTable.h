@@ -0,0 +1,43 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include "Packet.h"
+#include "PlayerTable.h"
+
+#define SESSION_RESUME_FRAMES 64
+
+// Game data sent to one player, numbered so a reconnecting client can say where it left off
+struct Session
+{
+	uint64_t m_Token = 0;
+	uint32_t m_Sequence = 0;
+	uint32_t m_Buffered = 0;
+	std::array<Packet, SESSION_RESUME_FRAMES> m_Frames;
+};
+
+// Opaque reconnect tokens of players, independent of their address
+class SessionTable
+{
+public:
+	uint64_t Open(uint8_t PlayerID);
+	void Restore(uint8_t PlayerID, uint64_t Token, uint32_t Sequence);
+	void Close(uint8_t PlayerID);
+	void Clear();
+	bool Find(uint64_t Token, uint8_t* pPlayerID) const;
+	uint64_t GetToken(uint8_t PlayerID) const;
+	uint32_t GetSequence(uint8_t PlayerID) const;
+	uint32_t NextSequence(uint8_t PlayerID);
+	void Record(uint8_t PlayerID, const Packet& Frame);
+	bool GetFrames(uint8_t PlayerID, uint32_t Sequence, std::vector<const Packet*>* pFrames) const;
+
+private:
+	uint64_t GenerateToken();
+
+	std::array<std::unique_ptr<Session>, MAX_PLAYERS> m_Sessions;
+	std::unordered_map<uint64_t, uint8_t> m_Tokens;
+	std::random_device m_Device;
+};
\ No newline at end of file
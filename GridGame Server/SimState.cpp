@@ -0,0 +1,163 @@
+#include "SimState.h"
+#include "Rules.h"
+
+SimState::SimState()
+{
+	m_X = 0;
+	m_Y = 0;
+	m_Width = 0;
+	m_Height = 0;
+}
+
+void SimState::Load(const Grid& Grid, uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height)
+{
+	m_X = X;
+	m_Y = Y;
+	m_Width = Width;
+	m_Height = Height;
+	m_Cells.resize((std::size_t)Width * Height);
+
+	for (uint16_t y = 0; y < Height; y++)
+	{
+		for (uint16_t x = 0; x < Width; x++)
+			m_Cells[(std::size_t)y * Width + x] = Pack(Grid.Get(X + x, Y + y));
+	}
+}
+
+bool SimState::ApplyMove(bool Split, int FromX, int FromY, int ToX, int ToY, uint8_t PlayerID)
+{
+	if (Rules::CheckPath(FromX, FromY, ToX, ToY, m_Width, m_Height) != MoveResult::MOVE_OK)
+		return false;
+
+	SimCell& OriginCell = m_Cells[(std::size_t)FromY * m_Width + FromX];
+	SimCell& TargetCell = m_Cells[(std::size_t)ToY * m_Width + ToX];
+	Field Origin = Unpack(OriginCell);
+
+	if (Rules::CheckWorker(Split, Origin, PlayerID) != MoveResult::MOVE_OK)
+		return false;
+
+	Field Target = Unpack(TargetCell);
+	Rules::ResolveMove(Split, &Origin, &Target);
+
+	OriginCell = Pack(Origin);
+	TargetCell = Pack(Target);
+
+	return true;
+}
+
+void SimState::PlayRandomTurn(Random* pRandom)
+{
+	ClearMoved();
+
+	// Every worker eats adjacent food when it can, otherwise wanders or holds
+	for (int y = 0; y < m_Height; y++)
+	{
+		for (int x = 0; x < m_Width; x++)
+		{
+			const SimCell& Cell = m_Cells[(std::size_t)y * m_Width + x];
+
+			// Workers that already moved carry the flag and are skipped
+			if (Cell.m_Type != (uint8_t)Field::FieldType::FIELD_WORKER)
+				continue;
+
+			uint32_t Random = (uint32_t)pRandom->Next();
+			uint32_t Direction = Random % SIM_DIRECTIONS;
+			uint8_t OwnerID = Cell.m_OwnerID;
+			bool Split = Cell.m_Power >= 4 && (Random & 0x100);
+
+			int StepX, StepY;
+
+			for (uint32_t i = 0; i < SIM_DIRECTIONS; i++)
+			{
+				GetDirection((Direction + i) % SIM_DIRECTIONS, &StepX, &StepY);
+
+				if (IsInside(x + StepX, y + StepY) && m_Cells[(std::size_t)(y + StepY) * m_Width + x + StepX].m_Type == (uint8_t)Field::FieldType::FIELD_FOOD)
+				{
+					Direction = (Direction + i) % SIM_DIRECTIONS;
+					Split = false;
+					break;
+				}
+			}
+
+			if ((Random & 0x600) == 0)
+				continue;
+
+			GetDirection(Direction, &StepX, &StepY);
+			ApplyMove(Split, x, y, x + StepX, y + StepY, OwnerID);
+		}
+	}
+}
+
+void SimState::ClearMoved()
+{
+	for (SimCell& Cell : m_Cells)
+		Cell.m_Type &= ~SIM_MOVED_FLAG;
+}
+
+void SimState::GetPower(std::array<int32_t, GRID_MAX_OWNERS>* pPower) const
+{
+	pPower->fill(0);
+
+	for (const SimCell& Cell : m_Cells)
+	{
+		if ((Cell.m_Type & ~SIM_MOVED_FLAG) == (uint8_t)Field::FieldType::FIELD_WORKER)
+			(*pPower)[Cell.m_OwnerID] += Cell.m_Power;
+	}
+}
+
+Field SimState::Get(int x, int y) const
+{
+	return Unpack(m_Cells[(std::size_t)y * m_Width + x]);
+}
+
+bool SimState::IsInside(int x, int y) const
+{
+	return x >= 0 && x < m_Width && y >= 0 && y < m_Height;
+}
+
+uint16_t SimState::GetX() const
+{
+	return m_X;
+}
+
+uint16_t SimState::GetY() const
+{
+	return m_Y;
+}
+
+uint16_t SimState::GetWidth() const
+{
+	return m_Width;
+}
+
+uint16_t SimState::GetHeight() const
+{
+	return m_Height;
+}
+
+void SimState::GetDirection(uint32_t Direction, int* pX, int* pY)
+{
+	static constexpr int DirectionX[SIM_DIRECTIONS] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+	static constexpr int DirectionY[SIM_DIRECTIONS] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+	*pX = DirectionX[Direction];
+	*pY = DirectionY[Direction];
+}
+
+SimCell SimState::Pack(const Field& Field)
+{
+	SimCell Cell;
+	Cell.m_Type = (uint8_t)Field.m_FieldType | (Field.m_WasMoved ? SIM_MOVED_FLAG : 0);
+	Cell.m_OwnerID = Field.m_OwnerID;
+	Cell.m_Power = Field.m_Power;
+
+	return Cell;
+}
+
+Field SimState::Unpack(const SimCell& Cell)
+{
+	Field Field((Field::FieldType)(Cell.m_Type & ~SIM_MOVED_FLAG), Cell.m_OwnerID, Cell.m_Power);
+	Field.m_WasMoved = Cell.m_Type & SIM_MOVED_FLAG;
+
+	return Field;
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "Grid.h"
+#include "Random.h"
+
+#define SIM_MAX_SIZE 64
+#define SIM_MOVED_FLAG 0x80
+#define SIM_DIRECTIONS 8
+
+// Field packed into 4 bytes, the moved flag lives in the top bit of the type
+struct SimCell
+{
+	uint8_t m_Type;
+	uint8_t m_OwnerID;
+	int16_t m_Power;
+};
+
+// Compact copy of a window of the grid, cheap to clone and play out on search threads.
+// Moves go through the regular rules, fields outside the window can't be entered
+class SimState
+{
+public:
+	SimState();
+	void Load(const Grid& Grid, uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height);
+	bool ApplyMove(bool Split, int FromX, int FromY, int ToX, int ToY, uint8_t PlayerID);
+	void PlayRandomTurn(Random* pRandom);
+	void ClearMoved();
+	void GetPower(std::array<int32_t, GRID_MAX_OWNERS>* pPower) const;
+
+	Field Get(int x, int y) const;
+	bool IsInside(int x, int y) const;
+	uint16_t GetX() const;
+	uint16_t GetY() const;
+	uint16_t GetWidth() const;
+	uint16_t GetHeight() const;
+
+	static void GetDirection(uint32_t Direction, int* pX, int* pY);
+
+private:
+	static SimCell Pack(const Field& Field);
+	static Field Unpack(const SimCell& Cell);
+
+	uint16_t m_X;
+	uint16_t m_Y;
+	uint16_t m_Width;
+	uint16_t m_Height;
+	std::vector<SimCell> m_Cells;
+};
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include <format>
+#include <chrono>
+#include <iostream>
+#include <array>
+#include <algorithm>
+#include "Simulation.h"
+#include "GridGame.h"
+#include "NetworkSink.h"
+#include "Allocations.h"
+#include "Logger.h"
+
+// Swallows all packets of a headless game
+class CountingSink : public NetworkSink
+{
+public:
+	void Send(const Packet& Packet, SOCKET Socket) override
+	{
+		m_Packets++;
+	}
+
+	uint64_t m_Packets = 0;
+};
+
+int Simulation::Run(const SimulationConfig& Config)
+{
+	if (Config.m_Bots.size() < 2)
+	{
+		std::cout << "A simulation needs at least two bots." << std::endl;
+		return 1;
+	}
+
+	for (uint16_t Size : Config.m_Sizes)
+	{
+		CountingSink Sink;
+		std::vector<double> Latencies;
+		uint64_t Turns = 0;
+		uint64_t Moves = 0;
+		uint64_t Allocs = 0;
+		std::array<uint64_t, (std::size_t)AllocationSite::SITE_COUNT> SiteAllocs = {};
+		std::array<uint64_t, (std::size_t)AllocationSite::SITE_COUNT> SiteAllocsBefore = {};
+		double Seconds = 0;
+
+		Latencies.reserve((std::size_t)Config.m_Matches * Config.m_MaxTurns);
+
+		// Game messages would dominate the measurement
+		Logger::SetLevel(LogLevel::LEVEL_WARNING);
+
+		for (uint32_t Match = 0; Match < Config.m_Matches; Match++)
+		{
+			GameConfig MatchConfig = Config.m_Game;
+			MatchConfig.m_GridWidth = Size;
+			MatchConfig.m_GridHeight = Size;
+			MatchConfig.m_Seed = Config.m_Game.m_Seed ? Config.m_Game.m_Seed + Match : Random::GenerateSeed();
+
+			GridGame Game(nullptr, MatchConfig);
+			Game.SetNetworkSink(&Sink);
+
+			std::vector<Bot> Bots;
+
+			for (std::size_t i = 0; i < Config.m_Bots.size(); i++)
+			{
+				Bots.push_back(Bot(Config.m_Bots[i], (SOCKET)(i + 1), MatchConfig.m_Seed ^ (i + 1)));
+				Bots.back().Connect(&Game);
+			}
+
+			Game.BeginMatch();
+
+			for (uint32_t Turn = 0; Turn < Config.m_MaxTurns && Game.IsGameRunning(); Turn++)
+			{
+				uint64_t AllocsBefore = Allocations::GetCount();
+
+				for (std::size_t i = 0; i < SiteAllocs.size(); i++)
+					SiteAllocsBefore[i] = Allocations::GetCount((AllocationSite)i);
+
+				auto Start = std::chrono::steady_clock::now();
+
+				for (Bot& Bot : Bots)
+				{
+					if (MatchConfig.m_SimultaneousTurns || Bot.IsTurnPlayer(&Game))
+						Moves += Bot.Play(&Game);
+				}
+
+				Game.AdvanceTurn(false);
+
+				double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+				Latencies.push_back(Elapsed);
+				Seconds += Elapsed;
+				Allocs += Allocations::GetCount() - AllocsBefore;
+
+				for (std::size_t i = 0; i < SiteAllocs.size(); i++)
+					SiteAllocs[i] += Allocations::GetCount((AllocationSite)i) - SiteAllocsBefore[i];
+
+				Turns++;
+			}
+		}
+
+		Logger::SetLevel(LogLevel::LEVEL_INFO);
+
+		if (Latencies.empty())
+			continue;
+
+		std::sort(Latencies.begin(), Latencies.end());
+
+		auto Percentile = [&Latencies](double Fraction)
+		{
+			return Latencies[std::min(Latencies.size() - 1, (std::size_t)(Fraction * Latencies.size()))] * 1e6;
+		};
+
+		std::cout << std::format("Board {}x{}: {} matches, {} turns in {:.3f}s ({:.0f} turns/s), {} moves ({:.0f} moves/s), {} packets",
+			Size, Size, Config.m_Matches, Turns, Seconds, Turns / Seconds, Moves, Moves / Seconds, Sink.m_Packets) << std::endl;
+
+		std::cout << std::format("  turn latency p50 {:.1f}us p90 {:.1f}us p99 {:.1f}us max {:.1f}us, allocations per turn {}",
+			Percentile(0.5), Percentile(0.9), Percentile(0.99), Latencies.back() * 1e6,
+			Allocations::IsTracking() ? std::format("{:.1f}", (double)Allocs / Turns) : "n/a (build with GRIDGAME_ALLOC_TRACKING)") << std::endl;
+
+		if (!Allocations::IsTracking())
+			continue;
+
+		// Where the allocations of a turn come from, packets by their type
+		std::string Sites;
+
+		for (std::size_t i = 0; i < SiteAllocs.size(); i++)
+		{
+			if (!SiteAllocs[i])
+				continue;
+
+			Sites += i >= (std::size_t)AllocationSite::SITE_PACKET
+				? std::format(" packet {} {:.1f},", i - (std::size_t)AllocationSite::SITE_PACKET, (double)SiteAllocs[i] / Turns)
+				: std::format(" {} {:.1f},", Allocations::GetSiteName((AllocationSite)i), (double)SiteAllocs[i] / Turns);
+		}
+
+		if (!Sites.empty())
+			Sites.pop_back();
+
+		std::cout << std::format("  allocations per turn by site:{}", Sites) << std::endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
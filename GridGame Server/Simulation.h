@@ -0,0 +1,20 @@
+#pragma once
+#include <vector>
+#include "Bot.h"
+#include "GameConfig.h"
+
+struct SimulationConfig
+{
+	GameConfig m_Game;
+	uint32_t m_Matches = 100;
+	uint32_t m_MaxTurns = 500;
+	std::vector<uint16_t> m_Sizes = { 25, 64, 256 };
+	std::vector<BotType> m_Bots = { BotType::BOT_RANDOM, BotType::BOT_GREEDY_FOOD, BotType::BOT_AGGRESSIVE };
+};
+
+// Plays bot matches headless through the real game code and reports engine throughput
+class Simulation
+{
+public:
+	static int Run(const SimulationConfig& Config);
+};
\ No newline at end of file
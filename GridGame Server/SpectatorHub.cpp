@@ -0,0 +1,310 @@
+#include <chrono>
+#include <algorithm>
+#include "SpectatorHub.h"
+#include "GameNetInstructions.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "Allocations.h"
+
+SpectatorHub::SpectatorHub()
+{
+	m_Shutdown = false;
+	m_HasTurn = false;
+	m_Count = 0;
+
+	GetGameInstructions(&m_Instructions);
+	m_Serializer.SetInstructions(&m_Instructions);
+}
+
+SpectatorHub::~SpectatorHub()
+{
+	{
+		std::lock_guard LockGuard(m_Mutex);
+		m_Shutdown = true;
+	}
+
+	m_Wakeup.notify_one();
+
+	if (m_Thread.joinable())
+		m_Thread.join();
+}
+
+void SpectatorHub::Start()
+{
+	if (!m_Thread.joinable())
+		m_Thread = std::thread(&SpectatorHub::Routine, this);
+}
+
+void SpectatorHub::Add(SOCKET Socket)
+{
+	std::lock_guard LockGuard(m_Mutex);
+
+	if (std::find(m_Joining.begin(), m_Joining.end(), Socket) != m_Joining.end())
+		return;
+
+	m_Joining.push_back(Socket);
+	m_Count++;
+}
+
+void SpectatorHub::Remove(SOCKET Socket)
+{
+	// Waits for a running flush, the socket may be closed right after
+	std::lock_guard SpectatorGuard(m_SpectatorMutex);
+	std::lock_guard LockGuard(m_Mutex);
+
+	auto It = std::find(m_Joining.begin(), m_Joining.end(), Socket);
+
+	if (It != m_Joining.end())
+	{
+		m_Joining.erase(It);
+		m_Count--;
+		return;
+	}
+
+	for (Spectator& Spectator : m_Spectators)
+	{
+		if (Spectator.m_Socket != Socket)
+			continue;
+
+		Spectator.m_Socket = INVALID_SOCKET;
+		m_Count--;
+	}
+}
+
+void SpectatorHub::Publish(SpectatorTurn Turn)
+{
+	{
+		std::lock_guard LockGuard(m_Mutex);
+		m_PendingTurns.push_back(std::move(Turn));
+	}
+
+	m_Wakeup.notify_one();
+}
+
+bool SpectatorHub::HasSpectators() const
+{
+	return m_Count > 0;
+}
+
+void SpectatorHub::Routine()
+{
+	AllocationScope Allocations(AllocationSite::SITE_SPECTATORS);
+	std::vector<SpectatorTurn> Turns;
+
+	while (true)
+	{
+		{
+			std::unique_lock Lock(m_Mutex);
+			m_Wakeup.wait_for(Lock, std::chrono::milliseconds(SPECTATOR_PACE_MS), [this] { return m_Shutdown || !m_PendingTurns.empty(); });
+
+			if (m_Shutdown)
+				return;
+
+			Turns.swap(m_PendingTurns);
+		}
+
+		std::lock_guard SpectatorGuard(m_SpectatorMutex);
+
+		{
+			std::lock_guard LockGuard(m_Mutex);
+
+			for (SOCKET Socket : m_Joining)
+				m_Spectators.push_back({ Socket, true, 0, 0, {} });
+
+			m_Joining.clear();
+		}
+
+		for (SpectatorTurn& Turn : Turns)
+			Distribute(Turn);
+
+		Turns.clear();
+
+		std::size_t QueuedFrames = 0;
+
+		for (Spectator& Spectator : m_Spectators)
+		{
+			Flush(&Spectator);
+			QueuedFrames += Spectator.m_Frames.size();
+		}
+
+		Metrics::Set(MetricGauge::GAUGE_SPECTATORS, (int64_t)m_Count);
+		Metrics::Set(MetricGauge::GAUGE_OUTBOUND_QUEUE, (int64_t)QueuedFrames);
+
+		// Forget viewers which left or were dropped
+		std::erase_if(m_Spectators, [](const Spectator& Spectator) { return Spectator.m_Socket == INVALID_SOCKET; });
+	}
+}
+
+void SpectatorHub::Distribute(SpectatorTurn& Turn)
+{
+	TraceScope Scope("SpectatorDistribute");
+
+	SpectatorFrame Frame;
+
+	// Every viewer shares the same encoded frame
+	if (!m_Spectators.empty())
+	{
+		Packet Packet(NetDataType::NET_GAME_DATA);
+		Packet.push_back(Turn.TurnPlayerID);
+		Packet.push_back(Turn.TurnTimeout);
+		Packet.push_back(Turn.Changes);
+		Packet.push_back(Turn.Food);
+		Packet.push_back(Turn.Turn);
+
+		Frame = Encode(Packet);
+	}
+
+	for (Spectator& Spectator : m_Spectators)
+	{
+		if (Spectator.m_Socket == INVALID_SOCKET || Spectator.m_NeedsKeyframe)
+			continue;
+
+		// A new match or a rollback can't be followed from the old stream
+		if (Turn.Keyframe)
+		{
+			SkipAhead(&Spectator);
+			continue;
+		}
+
+		if (Spectator.m_Frames.size() >= SPECTATOR_MAX_QUEUE)
+		{
+			Spectator.m_Skips++;
+			SkipAhead(&Spectator);
+		}
+		else
+			Spectator.m_Frames.push_back(Frame);
+	}
+
+	// The keyframe of the latest turn is built once someone needs it
+	Turn.Changes.clear();
+	m_Turn = std::move(Turn);
+	m_HasTurn = true;
+	m_Keyframe.reset();
+}
+
+void SpectatorHub::Flush(Spectator* pSpectator)
+{
+	if (pSpectator->m_Socket == INVALID_SOCKET)
+		return;
+
+	// Viewers which never catch up only cost us
+	if (pSpectator->m_Skips > SPECTATOR_MAX_SKIPS)
+	{
+		shutdown(pSpectator->m_Socket, SD_BOTH);
+		pSpectator->m_Socket = INVALID_SOCKET;
+		m_Count--;
+		return;
+	}
+
+	if (pSpectator->m_NeedsKeyframe && m_HasTurn)
+	{
+		pSpectator->m_Frames.push_back(GetKeyframe());
+		pSpectator->m_NeedsKeyframe = false;
+	}
+
+	while (!pSpectator->m_Frames.empty())
+	{
+		const std::vector<char>& Frame = *pSpectator->m_Frames.front();
+
+		int SentBytes = send(pSpectator->m_Socket, Frame.data() + pSpectator->m_Offset, (int)(Frame.size() - pSpectator->m_Offset), 0);
+
+		// Full socket buffer, try again on the next round
+		if (SentBytes == SOCKET_ERROR)
+		{
+			if (WSAGetLastError() == WSAEWOULDBLOCK)
+				return;
+
+			shutdown(pSpectator->m_Socket, SD_BOTH);
+			pSpectator->m_Socket = INVALID_SOCKET;
+			m_Count--;
+			return;
+		}
+
+		pSpectator->m_Offset += SentBytes;
+
+		if (pSpectator->m_Offset < Frame.size())
+			return;
+
+		pSpectator->m_Frames.pop_front();
+		pSpectator->m_Offset = 0;
+	}
+
+	pSpectator->m_Skips = 0;
+}
+
+void SpectatorHub::SkipAhead(Spectator* pSpectator)
+{
+	// Keep a partly sent frame or the stream breaks
+	while (pSpectator->m_Frames.size() > (pSpectator->m_Offset ? 1 : 0))
+		pSpectator->m_Frames.pop_back();
+
+	pSpectator->m_NeedsKeyframe = true;
+}
+
+SpectatorFrame SpectatorHub::GetKeyframe()
+{
+	if (m_Keyframe)
+		return m_Keyframe;
+
+	TraceScope Scope("SpectatorKeyframe");
+
+	// Whole grid of the latest turn
+	std::vector<PacketStruct> Fields;
+	uint16_t ChunksX = (m_Turn.Grid.GetWidth() + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE;
+	uint16_t ChunksY = (m_Turn.Grid.GetHeight() + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE;
+
+	for (uint32_t ChunkIndex = 0; ChunkIndex < (uint32_t)ChunksX * ChunksY; ChunkIndex++)
+	{
+		const Chunk* pChunk = m_Turn.Grid.GetChunk(ChunkIndex);
+
+		if (!pChunk)
+			continue;
+
+		for (uint32_t i = 0; i < GRID_CHUNK_FIELDS; i++)
+		{
+			const Field& Field = pChunk->m_Fields[i];
+
+			if (Field.m_FieldType == Field::FieldType::FIELD_EMPTY)
+				continue;
+
+			Fields.push_back(
+				{
+					(uint16_t)((ChunkIndex % ChunksX) * GRID_CHUNK_SIZE + i % GRID_CHUNK_SIZE),
+					(uint16_t)((ChunkIndex / ChunksX) * GRID_CHUNK_SIZE + i / GRID_CHUNK_SIZE),
+					(uint8_t)Field.m_FieldType,
+					(uint8_t)Field.m_OwnerID,
+					(uint16_t)Field.m_Power
+				}
+			);
+		}
+	}
+
+	Packet Packet(NetDataType::NET_GAME_DATA);
+	Packet.push_back(m_Turn.TurnPlayerID);
+	Packet.push_back(m_Turn.TurnTimeout);
+	Packet.push_back(Fields);
+	Packet.push_back(m_Turn.Food);
+	Packet.push_back(m_Turn.Turn);
+
+	// Roster first, so the viewer knows the grid size
+	SpectatorFrame Start = Encode(m_Turn.Start);
+	SpectatorFrame Data = Encode(Packet);
+
+	std::shared_ptr<std::vector<char>> pKeyframe = std::make_shared<std::vector<char>>(*Start);
+	pKeyframe->insert(pKeyframe->end(), Data->begin(), Data->end());
+
+	m_Keyframe = pKeyframe;
+
+	return m_Keyframe;
+}
+
+SpectatorFrame SpectatorHub::Encode(const Packet& Packet)
+{
+	uint64_t EncodeStart = Metrics::GetTime();
+	std::size_t TotalBytes = m_Serializer.Serialize(Packet, &m_Buffer);
+
+	Metrics::Record(MetricHistogram::HISTOGRAM_ENCODE_NS, Metrics::GetTime() - EncodeStart);
+	Metrics::CountSent(Packet.m_Magic);
+
+	return std::make_shared<const std::vector<char>>(m_Buffer.begin(), m_Buffer.begin() + TotalBytes);
+}
\ No newline at end of file
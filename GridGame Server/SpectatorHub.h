@@ -0,0 +1,80 @@
+#pragma once
+#include <map>
+#include <deque>
+#include <mutex>
+#include <ctime>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+#include <winsock2.h>
+#include "Grid.h"
+#include "Packet.h"
+#include "Serializer.h"
+#include "Instruction.h"
+
+#define SPECTATOR_PACE_MS 10
+#define SPECTATOR_MAX_QUEUE 8
+#define SPECTATOR_MAX_SKIPS 4
+
+typedef std::shared_ptr<const std::vector<char>> SpectatorFrame;
+
+// Everything spectators need of one turn, the snapshot shares its chunks with the game
+struct SpectatorTurn
+{
+	bool Keyframe;
+	uint8_t TurnPlayerID;
+	uint32_t Turn;
+	std::time_t TurnTimeout;
+	Packet Start;
+	GridSnapshot Grid;
+	std::vector<PacketStruct> Changes;
+	std::vector<PacketStruct> Food;
+};
+
+struct Spectator
+{
+	SOCKET m_Socket;
+	bool m_NeedsKeyframe;
+	uint32_t m_Skips;
+	std::size_t m_Offset;
+	std::deque<SpectatorFrame> m_Frames;
+};
+
+// Sends the turns of a match to read only viewers, encoded once and paced apart from the players
+class SpectatorHub
+{
+public:
+	SpectatorHub();
+	~SpectatorHub();
+	void Start();
+	void Add(SOCKET Socket);
+	void Remove(SOCKET Socket);
+	void Publish(SpectatorTurn Turn);
+	bool HasSpectators() const;
+
+private:
+	void Routine();
+	void Distribute(SpectatorTurn& Turn);
+	void Flush(Spectator* pSpectator);
+	void SkipAhead(Spectator* pSpectator);
+	SpectatorFrame GetKeyframe();
+	SpectatorFrame Encode(const Packet& Packet);
+
+	bool m_Shutdown;
+	bool m_HasTurn;
+	std::mutex m_Mutex;
+	std::mutex m_SpectatorMutex;
+	std::condition_variable m_Wakeup;
+	std::atomic<std::size_t> m_Count;
+	std::thread m_Thread;
+	std::vector<SOCKET> m_Joining;
+	std::vector<SpectatorTurn> m_PendingTurns;
+	std::vector<Spectator> m_Spectators;
+	std::map<NetDataType, Instruction> m_Instructions;
+	Serializer m_Serializer;
+	std::vector<char> m_Buffer;
+	SpectatorTurn m_Turn;
+	SpectatorFrame m_Keyframe;
+};
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(std::size_t Threads)
+{
+	m_Shutdown = false;
+	m_Busy = 0;
+
+	for (std::size_t i = 0; i < std::max<std::size_t>(Threads, 1); i++)
+		m_Threads.emplace_back(&ThreadPool::Work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard LockGuard(m_Mutex);
+		m_Shutdown = true;
+	}
+
+	m_TaskReady.notify_all();
+
+	for (std::thread& Thread : m_Threads)
+		Thread.join();
+}
+
+void ThreadPool::Submit(std::function<void()> Task)
+{
+	{
+		std::lock_guard LockGuard(m_Mutex);
+		m_Tasks.push(std::move(Task));
+	}
+
+	m_TaskReady.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+	std::unique_lock Lock(m_Mutex);
+	m_TasksDone.wait(Lock, [this] { return m_Tasks.empty() && m_Busy == 0; });
+}
+
+std::size_t ThreadPool::GetSize() const
+{
+	return m_Threads.size();
+}
+
+void ThreadPool::Work()
+{
+	while (true)
+	{
+		std::function<void()> Task;
+
+		{
+			std::unique_lock Lock(m_Mutex);
+			m_TaskReady.wait(Lock, [this] { return m_Shutdown || !m_Tasks.empty(); });
+
+			if (m_Tasks.empty())
+				return;
+
+			Task = std::move(m_Tasks.front());
+			m_Tasks.pop();
+			m_Busy++;
+		}
+
+		Task();
+
+		{
+			std::lock_guard LockGuard(m_Mutex);
+			m_Busy--;
+		}
+
+		m_TasksDone.notify_all();
+	}
+}
\ No newline at end of file
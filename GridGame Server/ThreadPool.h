@@ -0,0 +1,29 @@
+#pragma once
+#include <queue>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+// Fixed set of worker threads kept alive across tasks
+class ThreadPool
+{
+public:
+	ThreadPool(std::size_t Threads);
+	~ThreadPool();
+	void Submit(std::function<void()> Task);
+	void Wait();
+	std::size_t GetSize() const;
+
+private:
+	void Work();
+
+	bool m_Shutdown;
+	std::size_t m_Busy;
+	std::mutex m_Mutex;
+	std::condition_variable m_TaskReady;
+	std::condition_variable m_TasksDone;
+	std::queue<std::function<void()>> m_Tasks;
+	std::vector<std::thread> m_Threads;
+};
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <mutex>
+#include <chrono>
+#include <format>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include "Trace.h"
+
+static std::atomic<bool> s_Enabled = false;
+static std::atomic<uint64_t> s_Match = 0;
+
+static std::mutex& GetRingMutex()
+{
+	static std::mutex s_Mutex;
+	return s_Mutex;
+}
+
+static std::vector<std::unique_ptr<TraceRing>>& GetRings()
+{
+	static std::vector<std::unique_ptr<TraceRing>> s_Rings;
+	return s_Rings;
+}
+
+void Trace::SetEnabled(bool Enabled)
+{
+	s_Enabled.store(Enabled, std::memory_order_relaxed);
+}
+
+bool Trace::IsEnabled()
+{
+	return s_Enabled.load(std::memory_order_relaxed);
+}
+
+void Trace::SetMatch(uint64_t Match)
+{
+	s_Match.store(Match, std::memory_order_relaxed);
+}
+
+TraceRing* Trace::GetRing()
+{
+	thread_local TraceRing* t_pRing = nullptr;
+
+	if (t_pRing)
+		return t_pRing;
+
+	// Only threads which ever trace pay for a ring
+	std::unique_ptr<TraceRing> pRing = std::make_unique<TraceRing>();
+	t_pRing = pRing.get();
+
+	std::lock_guard LockGuard(GetRingMutex());
+	t_pRing->m_ThreadID = (uint32_t)GetRings().size() + 1;
+	GetRings().push_back(std::move(pRing));
+
+	return t_pRing;
+}
+
+void Trace::Record(const char* pName, uint64_t Start, uint64_t End)
+{
+	TraceRing* pRing = GetRing();
+	uint64_t Head = pRing->m_Head.load(std::memory_order_relaxed);
+
+	pRing->m_Events[Head % TRACE_RING_SIZE] = { pName, Start, End - Start, s_Match.load(std::memory_order_relaxed) };
+	pRing->m_Head.store(Head + 1, std::memory_order_release);
+}
+
+uint64_t Trace::GetTime()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string Trace::Export(uint64_t Match, uint64_t From, uint64_t To)
+{
+	std::string Json = "{\"traceEvents\":[\n";
+	bool IsFirst = true;
+
+	std::lock_guard LockGuard(GetRingMutex());
+
+	for (const std::unique_ptr<TraceRing>& pRing : GetRings())
+	{
+		uint64_t Head = pRing->m_Head.load(std::memory_order_acquire);
+		uint64_t First = Head > TRACE_RING_SIZE ? Head - TRACE_RING_SIZE : 0;
+
+		std::vector<TraceEvent> Events;
+		Events.reserve(Head - First);
+
+		for (uint64_t i = First; i < Head; i++)
+			Events.push_back(pRing->m_Events[i % TRACE_RING_SIZE]);
+
+		// Skip slots the thread overwrote while they were copied, the oldest one may be half written
+		uint64_t Overwritten = pRing->m_Head.load(std::memory_order_acquire) - Head + (Head >= TRACE_RING_SIZE ? 1 : 0);
+		std::size_t Skip = (std::size_t)std::min<uint64_t>(Overwritten, Events.size());
+
+		for (std::size_t i = Skip; i < Events.size(); i++)
+		{
+			const TraceEvent& Event = Events[i];
+
+			if ((Match && Event.m_Match != Match) || Event.m_Start < From || Event.m_Start > To)
+				continue;
+
+			Json += std::format("{}{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"match\":{}}}}}",
+				IsFirst ? "" : ",\n", Event.m_pName, pRing->m_ThreadID, Event.m_Start / 1000.0, Event.m_Duration / 1000.0, Event.m_Match);
+
+			IsFirst = false;
+		}
+	}
+
+	Json += "\n]}\n";
+
+	return Json;
+}
+
+bool Trace::Dump(const std::string& Path, uint64_t Match, uint64_t From, uint64_t To)
+{
+	std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+
+	if (!File)
+		return false;
+
+	std::string Json = Export(Match, From, To);
+	File.write(Json.data(), (std::streamsize)Json.size());
+
+	return (bool)File;
+}
\ No newline at end of file
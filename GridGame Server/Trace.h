@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+#define TRACE_RING_SIZE 65536
+
+struct TraceEvent
+{
+	const char* m_pName;
+	uint64_t m_Start;
+	uint64_t m_Duration;
+	uint64_t m_Match;
+};
+
+// Latest spans of one thread, older ones get overwritten
+struct TraceRing
+{
+	uint32_t m_ThreadID;
+	std::atomic<uint64_t> m_Head;
+	std::array<TraceEvent, TRACE_RING_SIZE> m_Events;
+};
+
+// Spans of the hot paths, exported as Chrome trace event JSON
+class Trace
+{
+public:
+	static void SetEnabled(bool Enabled);
+	static bool IsEnabled();
+	static void SetMatch(uint64_t Match);
+	static void Record(const char* pName, uint64_t Start, uint64_t End);
+	static uint64_t GetTime();
+	static std::string Export(uint64_t Match = 0, uint64_t From = 0, uint64_t To = UINT64_MAX);
+	static bool Dump(const std::string& Path, uint64_t Match = 0, uint64_t From = 0, uint64_t To = UINT64_MAX);
+
+private:
+	static TraceRing* GetRing();
+};
+
+// Records the lifetime of a block, costs one load while tracing is off
+class TraceScope
+{
+public:
+	TraceScope(const char* pName)
+	{
+		m_pName = pName;
+		m_Start = Trace::IsEnabled() ? Trace::GetTime() : 0;
+	}
+
+	~TraceScope()
+	{
+		if (m_Start)
+			Trace::Record(m_pName, m_Start, Trace::GetTime());
+	}
+
+private:
+	const char* m_pName;
+	uint64_t m_Start;
+};
\ No newline at end of file
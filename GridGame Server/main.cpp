@@ -1,11 +1,165 @@
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
 #include "Server.h"
 #include "GridGame.h"
+#include "Replay.h"
+#include "Simulation.h"
+#include "LoadTest.h"
+#include "Benchmark.h"
+#include "MetricsEndpoint.h"
+#include "Logger.h"
+#include "Trace.h"
 
-int main()
+int main(int argc, char* argv[])
 {
-    Server* pServer = new Server();
+    GameConfig Config;
+    SimulationConfig SimConfig;
+    LoadTestConfig LoadConfig;
+    OutboundLimits Limits;
+    RateLimits Rates;
+    std::string Address = SERVER_DEFAULT_ADDRESS;
+    std::string Port = SERVER_DEFAULT_PORT;
+    std::string MetricsPort;
+    bool Simulate = false;
+    bool RunLoadTest = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--width") && i + 1 < argc)
+            Config.m_GridWidth = (uint16_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--height") && i + 1 < argc)
+            Config.m_GridHeight = (uint16_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--turn-seconds") && i + 1 < argc)
+            Config.m_TurnSeconds = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc)
+            Config.m_Seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--simultaneous"))
+            Config.m_SimultaneousTurns = true;
+        else if (!std::strcmp(argv[i], "--log-dir") && i + 1 < argc)
+            Config.m_LogDirectory = argv[++i];
+        else if (!std::strcmp(argv[i], "--checkpoint-dir") && i + 1 < argc)
+            Config.m_CheckpointDirectory = argv[++i];
+        else if (!std::strcmp(argv[i], "--checkpoint-turns") && i + 1 < argc)
+            Config.m_CheckpointTurns = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--send-hash"))
+            Config.m_SendGridHash = true;
+        else if (!std::strcmp(argv[i], "--replay") && i + 1 < argc)
+            return Replay::Run(argv[++i]);
+        else if (!std::strcmp(argv[i], "--bind") && i + 1 < argc)
+            Address = argv[++i];
+        else if (!std::strcmp(argv[i], "--port") && i + 1 < argc)
+            Port = argv[++i];
+        else if (!std::strcmp(argv[i], "--outbound-bytes") && i + 1 < argc)
+            Limits.m_MaxBytes = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--outbound-frames") && i + 1 < argc)
+            Limits.m_MaxFrames = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--outbound-disconnect-bytes") && i + 1 < argc)
+            Limits.m_DisconnectBytes = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--outbound-stall-seconds") && i + 1 < argc)
+            Limits.m_StallSeconds = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--rate-limit") && i + 1 < argc)
+            RateLimiter::ParseBudget(argv[++i], &Rates);
+        else if (!std::strcmp(argv[i], "--max-connections") && i + 1 < argc)
+            Rates.m_MaxConnections = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--max-connections-per-ip") && i + 1 < argc)
+            Rates.m_MaxAddressConnections = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--log-level") && i + 1 < argc)
+        {
+            LogLevel Level;
+
+            if (Logger::ParseLevel(argv[++i], &Level))
+                Logger::SetLevel(Level);
+        }
+        else if (!std::strcmp(argv[i], "--trace"))
+            Trace::SetEnabled(true);
+        else if (!std::strcmp(argv[i], "--trace-dir") && i + 1 < argc)
+            Config.m_TraceDirectory = argv[++i];
+        else if (!std::strcmp(argv[i], "--trace-slow-ms") && i + 1 < argc)
+            Config.m_TraceSlowTurnMs = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--metrics-port") && i + 1 < argc)
+            MetricsPort = argv[++i];
+        else if (!std::strcmp(argv[i], "--loadtest"))
+            RunLoadTest = true;
+        else if (!std::strcmp(argv[i], "--lt-host") && i + 1 < argc)
+            LoadConfig.m_Host = argv[++i];
+        else if (!std::strcmp(argv[i], "--lt-port") && i + 1 < argc)
+            LoadConfig.m_Port = argv[++i];
+        else if (!std::strcmp(argv[i], "--lt-clients") && i + 1 < argc)
+            LoadConfig.m_Clients = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--lt-seconds") && i + 1 < argc)
+            LoadConfig.m_Seconds = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--lt-move-rate") && i + 1 < argc)
+            LoadConfig.m_MoveRate = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--lt-end-turn-rate") && i + 1 < argc)
+            LoadConfig.m_EndTurnRate = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--lt-output") && i + 1 < argc)
+            LoadConfig.m_OutputPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--bench-serializer"))
+            return Benchmark::RunSerializer();
+        else if (!std::strcmp(argv[i], "--bench-mcts"))
+            return Benchmark::RunMcts();
+        else if (!std::strcmp(argv[i], "--ai-players") && i + 1 < argc)
+            Config.m_AIPlayers = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--ai-fill-seconds") && i + 1 < argc)
+            Config.m_AIFillSeconds = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--ai-budget-ms") && i + 1 < argc)
+            Config.m_AIBudgetMs = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--ai-threads") && i + 1 < argc)
+            Config.m_AIThreads = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--simulate"))
+            Simulate = true;
+        else if (!std::strcmp(argv[i], "--sim-matches") && i + 1 < argc)
+            SimConfig.m_Matches = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--sim-turns") && i + 1 < argc)
+            SimConfig.m_MaxTurns = (uint32_t)std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--sim-sizes") && i + 1 < argc)
+        {
+            std::stringstream List(argv[++i]);
+            std::string Item;
+
+            SimConfig.m_Sizes.clear();
+
+            while (std::getline(List, Item, ','))
+                SimConfig.m_Sizes.push_back((uint16_t)std::atoi(Item.c_str()));
+        }
+        else if (!std::strcmp(argv[i], "--sim-bots") && i + 1 < argc)
+        {
+            std::stringstream List(argv[++i]);
+            std::string Item;
+            BotType Type;
+
+            SimConfig.m_Bots.clear();
+
+            while (std::getline(List, Item, ','))
+            {
+                if (Bot::ParseType(Item, &Type))
+                    SimConfig.m_Bots.push_back(Type);
+            }
+        }
+    }
+
+    if (Simulate)
+    {
+        SimConfig.m_Game = Config;
+        return Simulation::Run(SimConfig);
+    }
+
+    if (RunLoadTest)
+        return LoadTest(LoadConfig).Run();
+
+    MetricsEndpoint Endpoint;
+
+    if (!MetricsPort.empty())
+        Endpoint.Start(MetricsPort);
+
+    Server* pServer = new Server(Address, Port);
+    pServer->SetOutboundLimits(Limits);
+    pServer->SetRateLimits(Rates);
+
+    g_pGridGame = new GridGame(pServer, Config);
+    g_pGridGame->RecoverCheckpoint();
 
-    g_pGridGame = new GridGame(pServer);
     std::thread GameThread(&GridGame::Routine, g_pGridGame);
 
     pServer->Start();